@@ -0,0 +1,17 @@
+#ifndef FIRST_PROJECT_DA_CAPACITY_H
+#define FIRST_PROJECT_DA_CAPACITY_H
+
+#include <cstdint>
+
+/**
+ * Type of the capacities, flows and demands of the network.
+ * The dataset only has whole numbers, so they are 64 bit integers: sums and comparisons of flows are exact.
+ * Building with DA_FRACTIONAL_CAPACITY makes them doubles, for datasets with fractional capacities.
+*/
+#ifdef DA_FRACTIONAL_CAPACITY
+typedef double Capacity;
+#else
+typedef int64_t Capacity;
+#endif
+
+#endif //FIRST_PROJECT_DA_CAPACITY_H
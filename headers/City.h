@@ -1,6 +1,7 @@
 #ifndef FIRST_PROJECT_DA_CITY_H
 #define FIRST_PROJECT_DA_CITY_H
 
+#include "Capacity.h"
 #include "Element.h"
 #include <string>
 
@@ -11,19 +12,20 @@
 class City : public Element {
     private:
         std::string name;
-        int demand;
+        Capacity demand;
         int population;
     public:
-        City(int id, std::string code, std::string name, int demand, int population);
-        int getDemand() const;
+        City(int id, std::string code, std::string name, Capacity demand, int population);
+        Capacity getDemand() const;
         int getPopulation() const;
         std::string getName() const;
+        void setDemand(Capacity demand);
 };
 
 /**
  * Getter for water demand.
 */
-inline int City::getDemand() const {
+inline Capacity City::getDemand() const {
     return demand;
 }
 
@@ -41,11 +43,18 @@ inline std::string City::getName() const {
     return name;
 }
 
+/**
+ * Setter for water demand.
+*/
+inline void City::setDemand(Capacity demand) {
+    this->demand = demand;
+}
+
 /**
  * Only constructor for the class.
  * The variables are self-explanatory
 */
-inline City::City(int id, std::string code, std::string name, int demand, int population)
-: Element(id, code), name(name), demand(demand), population(population) {}
+inline City::City(int id, std::string code, std::string name, Capacity demand, int population)
+: Element(id, code, ElementType::City), name(name), demand(demand), population(population) {}
 
 #endif //FIRST_PROJECT_DA_CITY_H
@@ -3,31 +3,44 @@
 
 #include <string>
 
+/**
+ * Kinds of elements in the network.
+*/
+enum class ElementType { Reservoir, Station, City };
+
 /**
  * Base class for all elements in the network.
  * All elements contain an id and a code.
+ * They also get a dense index when added to the manager, numbering them from 0,
+ * which is used instead of the code to store results by element.
 */
 class Element {
     private:
         int id;
         std::string code;
+        ElementType type;
+        int index = -1;
     public:
-        Element(int id, std::string code);
+        Element(int id, std::string code, ElementType type);
+        virtual ~Element() = default;
         int getId() const;
-        virtual std::string getCode() const;
+        const std::string &getCode() const;
+        ElementType getType() const;
+        int getIndex() const;
+        void setIndex(int index);
 };
 
 /**
  * Single constructor of this class.
  * Only used in contructors of derived classes.
 */
-inline Element::Element(int id, std::string code)
-    : id(id), code(code) {}
+inline Element::Element(int id, std::string code, ElementType type)
+    : id(id), code(code), type(type) {}
 
 /**
  * Getter for code.
 */
-inline std::string Element::getCode() const {
+inline const std::string &Element::getCode() const {
     return code;
 }
 
@@ -38,4 +51,25 @@ inline int Element::getId() const {
     return id;
 }
 
+/**
+ * Getter for type.
+*/
+inline ElementType Element::getType() const {
+    return type;
+}
+
+/**
+ * Getter for the dense index, -1 until the element is added to a manager or graph.
+*/
+inline int Element::getIndex() const {
+    return index;
+}
+
+/**
+ * Setter for the dense index.
+*/
+inline void Element::setIndex(int index) {
+    this->index = index;
+}
+
 #endif //FIRST_PROJECT_DA_ELEMENT_H
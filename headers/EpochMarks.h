@@ -0,0 +1,64 @@
+#ifndef FIRST_PROJECT_DA_EPOCHMARKS_H
+#define FIRST_PROJECT_DA_EPOCHMARKS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Stats.h"
+
+/**
+ * Marks on the items 0 to size - 1, such as the vertices reached by a search.
+ * Each item keeps the epoch in which it was last marked, so clearing every mark
+ * only starts a new epoch: a search pays for the items it reaches, not for all of them.
+ * The stamps are only wiped when the epoch counter wraps around.
+*/
+class EpochMarks {
+public:
+    EpochMarks(size_t size = 0);
+
+    void resize(size_t size);
+    size_t size() const;
+    void clear();
+    bool isMarked(int item) const;
+    void mark(int item);
+
+private:
+    std::vector<uint32_t> stamps;
+    uint32_t epoch = 1;
+};
+
+inline EpochMarks::EpochMarks(size_t size) : stamps(size, 0) {}
+
+/**
+ * Changes the number of items, new items starting unmarked.
+ * @note Complexity: O(n) for n new items
+*/
+inline void EpochMarks::resize(size_t size) {
+    stamps.resize(size, 0);
+}
+
+inline size_t EpochMarks::size() const {
+    return stamps.size();
+}
+
+/**
+ * Unmarks every item.
+ * @note Complexity: O(1), O(n) once every 2^32 calls
+*/
+inline void EpochMarks::clear() {
+    if (++epoch == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        epoch = 1;
+        STATS_ADD(VerticesReset, stamps.size());
+    }
+}
+
+inline bool EpochMarks::isMarked(int item) const {
+    return stamps[item] == epoch;
+}
+
+inline void EpochMarks::mark(int item) {
+    stamps[item] = epoch;
+}
+
+#endif //FIRST_PROJECT_DA_EPOCHMARKS_H
@@ -0,0 +1,410 @@
+#ifndef FIRST_PROJECT_DA_FLOWNETWORK_H
+#define FIRST_PROJECT_DA_FLOWNETWORK_H
+
+#include <vector>
+#include <utility>
+#include "Graph.h"
+
+/**
+ * Flat residual graph used by the max flow algorithms.
+ * It is built once from a Graph and stores every arc in compressed sparse row form:
+ * the arcs leaving vertex v are the ones in [begin(v), end(v)).
+ * Head, capacity and flow of the arcs are kept in parallel arrays, as Capacity values: exact integers
+ * unless built for fractional capacities, so the algorithms compare them without a tolerance.
+ * Each pipe becomes a pair of arcs (forward and reverse) linked through mate(),
+ * the flow of one being always the symmetric of the other.
+ * Vertices keep the position they had in the Graph, the super source and
+ * the super sink being the last two.
+ * Pipes and vertices can be disabled and enabled again in O(1), which is used to
+ * simulate failures without changing the graph: a disabled arc, or an arc going into
+ * a disabled vertex, has no capacity.
+ * The arcs of the super source and sink stay in the residual graph for as long as it lives,
+ * and are found in O(1) to change the supply of a reservoir or the demand of a city.
+*/
+class FlowNetwork {
+public:
+    typedef std::vector<std::pair<Vertex *, Capacity>> Terminals;
+
+    void build(const Graph &graph, const Terminals &sources, const Terminals &sinks);
+
+    int getNumVertex() const;
+    int getNumArcs() const;
+    int getSource() const;
+    int getSink() const;
+    Vertex *getVertex(int v) const;
+    Edge *getEdge(int arc) const;
+    int findVertex(Vertex *vertex) const;
+    int findArc(Edge *edge) const;
+    int findArc(int tail, int head) const;
+    int sourceArc(int v) const;
+    int sinkArc(int v) const;
+
+    int begin(int v) const;
+    int end(int v) const;
+    int head(int arc) const;
+    int mate(int arc) const;
+    Capacity capacity(int arc) const;
+    void setCapacity(int arc, Capacity capacity);
+    Capacity flow(int arc) const;
+    Capacity residual(int arc) const;
+    void push(int arc, Capacity amount);
+    Capacity inflow(int v) const;
+
+    bool isEnabled(int arc) const;
+    void setPipeEnabled(int arc, bool enabled);
+    void setVertexEnabled(int v, bool enabled);
+
+    void resetFlows();
+    void copyFlows(const FlowNetwork &other);
+    void readFlows();
+    void writeFlows() const;
+
+private:
+    std::vector<Vertex *> vertices;
+    std::vector<int> first;
+    std::vector<int> heads;
+    std::vector<int> mates;
+    std::vector<Capacity> capacities;
+    std::vector<Capacity> flows;
+    std::vector<Edge *> edges;
+    std::vector<char> arcEnabled;
+    std::vector<char> vertexEnabled;
+    std::vector<int> index; // Residual graph vertex of each element, by the index of the element
+    std::vector<int> sourceArcs; // Arc from the super source to each vertex, -1 if there is none
+    std::vector<int> sinkArcs; // Arc from each vertex to the super sink, -1 if there is none
+};
+
+/**
+ * Number of vertices, including the super source and the super sink.
+*/
+inline int FlowNetwork::getNumVertex() const {
+    return vertices.size();
+}
+
+/**
+ * Number of arcs, counting both arcs of every pair.
+*/
+inline int FlowNetwork::getNumArcs() const {
+    return heads.size();
+}
+
+/**
+ * Index of the super source.
+*/
+inline int FlowNetwork::getSource() const {
+    return vertices.size() - 2;
+}
+
+/**
+ * Index of the super sink.
+*/
+inline int FlowNetwork::getSink() const {
+    return vertices.size() - 1;
+}
+
+/**
+ * Graph vertex with a given index.
+ * The super source and sink have no vertex, returning nullptr.
+*/
+inline Vertex *FlowNetwork::getVertex(int v) const {
+    return vertices[v];
+}
+
+/**
+ * First arc leaving vertex v.
+*/
+inline int FlowNetwork::begin(int v) const {
+    return first[v];
+}
+
+/**
+ * One past the last arc leaving vertex v.
+*/
+inline int FlowNetwork::end(int v) const {
+    return first[v + 1];
+}
+
+/**
+ * Graph edge represented by an arc, nullptr for reverse arcs
+ * of one way pipes and for the arcs of the super source and sink.
+*/
+inline Edge *FlowNetwork::getEdge(int arc) const {
+    return edges[arc];
+}
+
+/**
+ * Index of a Graph vertex, -1 if it is not in the residual graph.
+ * @note Complexity: O(1)
+*/
+inline int FlowNetwork::findVertex(Vertex *vertex) const {
+    int element = vertex->getInfo()->getIndex();
+    return element < 0 || element >= (int)index.size() ? -1 : index[element];
+}
+
+/**
+ * Arc representing a Graph edge, -1 if it is not in the residual graph.
+ * @note Complexity: O(deg(v)) where v is the origin of the edge
+*/
+inline int FlowNetwork::findArc(Edge *edge) const {
+    int v = findVertex(edge->getOrig());
+    if (v == -1)
+        return -1;
+    for (int a = begin(v); a < end(v); a++) {
+        if (edges[a] == edge)
+            return a;
+    }
+    return -1;
+}
+
+/**
+ * First arc going from one vertex to another, -1 if there is none.
+ * @note Complexity: O(deg(tail))
+*/
+inline int FlowNetwork::findArc(int tail, int head) const {
+    for (int a = begin(tail); a < end(tail); a++) {
+        if (heads[a] == head)
+            return a;
+    }
+    return -1;
+}
+
+/**
+ * Arc from the super source to a vertex, -1 if the vertex is not a source.
+ * @note Complexity: O(1)
+*/
+inline int FlowNetwork::sourceArc(int v) const {
+    return sourceArcs[v];
+}
+
+/**
+ * Arc from a vertex to the super sink, -1 if the vertex is not a sink.
+ * @note Complexity: O(1)
+*/
+inline int FlowNetwork::sinkArc(int v) const {
+    return sinkArcs[v];
+}
+
+inline int FlowNetwork::head(int arc) const {
+    return heads[arc];
+}
+
+/**
+ * The arc going in the opposite direction of the given one.
+*/
+inline int FlowNetwork::mate(int arc) const {
+    return mates[arc];
+}
+
+/**
+ * Capacity of an arc, 0 while it is disabled.
+*/
+inline Capacity FlowNetwork::capacity(int arc) const {
+    return isEnabled(arc) ? capacities[arc] : 0;
+}
+
+inline Capacity FlowNetwork::flow(int arc) const {
+    return flows[arc];
+}
+
+/**
+ * Changes the capacity of an arc. The flow is kept, even if it no longer fits.
+*/
+inline void FlowNetwork::setCapacity(int arc, Capacity capacity) {
+    capacities[arc] = capacity;
+}
+
+/**
+ * How much more flow can be sent through an arc.
+*/
+inline Capacity FlowNetwork::residual(int arc) const {
+    return capacity(arc) - flows[arc];
+}
+
+/**
+ * Sends flow through an arc, updating its mate accordingly.
+*/
+inline void FlowNetwork::push(int arc, Capacity amount) {
+    flows[arc] += amount;
+    flows[mates[arc]] -= amount;
+}
+
+/**
+ * Flow entering a vertex through pipes, as the Graph edges would have it after writeFlows.
+ * @note Complexity: O(deg(v))
+*/
+inline Capacity FlowNetwork::inflow(int v) const {
+    Capacity total = 0;
+    for (int a = begin(v); a < end(v); a++) {
+        int in = mates[a];
+        if (edges[in] != nullptr && flows[in] > 0)
+            total += flows[in];
+    }
+    return total;
+}
+
+/**
+ * If an arc can carry flow: both the arc and the vertex it goes into are enabled.
+*/
+inline bool FlowNetwork::isEnabled(int arc) const {
+    return arcEnabled[arc] && vertexEnabled[heads[arc]];
+}
+
+/**
+ * Disables or enables a pipe, given one of its arcs. Both directions are affected.
+ * @note Complexity: O(1)
+*/
+inline void FlowNetwork::setPipeEnabled(int arc, bool enabled) {
+    arcEnabled[arc] = enabled;
+    arcEnabled[mates[arc]] = enabled;
+}
+
+/**
+ * Disables or enables a vertex. While disabled no flow can go into it,
+ * so none leaves it either.
+ * @note Complexity: O(1)
+*/
+inline void FlowNetwork::setVertexEnabled(int v, bool enabled) {
+    vertexEnabled[v] = enabled;
+}
+
+/**
+ * Sets the flow of every arc to 0.
+ * @note Complexity: O(E)
+*/
+inline void FlowNetwork::resetFlows() {
+    std::fill(flows.begin(), flows.end(), 0);
+}
+
+/**
+ * Sets the flow of every arc to the one it has in another residual graph built from the same network.
+ * @note Complexity: O(E)
+*/
+inline void FlowNetwork::copyFlows(const FlowNetwork &other) {
+    std::copy(other.flows.begin(), other.flows.end(), flows.begin());
+}
+
+/**
+ * Builds the residual graph from a Graph.
+ * Bidirectional pipes become a single pair of arcs with the capacity of the pipe in both directions,
+ * while one way pipes get a reverse arc without capacity. Everything starts enabled.
+ * @param sources Vertices connected to the super source and the capacity of that connection
+ * @param sinks Vertices connected to the super sink and the capacity of that connection
+ * @note Complexity: O(V + E)
+*/
+inline void FlowNetwork::build(const Graph &graph, const Terminals &sources, const Terminals &sinks) {
+    struct Pair {
+        int tail, head;
+        Capacity forward, backward;
+        Edge *forwardEdge, *backwardEdge;
+    };
+
+    Span<Vertex *> vertexSet = graph.getVertexSet();
+    vertices.assign(vertexSet.begin(), vertexSet.end());
+    int source = vertices.size();
+    int sink = source + 1;
+    vertices.push_back(nullptr);
+    vertices.push_back(nullptr);
+
+    index.clear();
+    for (int i = 0; i < source; i++) {
+        int element = vertices[i]->getInfo()->getIndex();
+        if (element >= (int)index.size())
+            index.resize(element + 1, -1);
+        index[element] = i;
+    }
+
+    // A bidirectional pipe is paired when its first edge is reached, from the vertex that comes first
+    std::vector<Pair> pairs;
+    for (int i = 0; i < source; i++) {
+        for (Edge *e : vertices[i]->getAdj()) {
+            int d = findVertex(e->getDest());
+            Edge *reverse = e->getReverse();
+            if (reverse != nullptr && (d < i || (d == i && reverse < e)))
+                continue;
+            pairs.push_back({i, d, e->getWeight(), reverse ? reverse->getWeight() : 0, e, reverse});
+        }
+    }
+    for (const auto &[v, cap] : sources)
+        pairs.push_back({source, findVertex(v), cap, 0, nullptr, nullptr});
+    for (const auto &[v, cap] : sinks)
+        pairs.push_back({findVertex(v), sink, cap, 0, nullptr, nullptr});
+
+    first.assign(vertices.size() + 1, 0);
+    for (const Pair &p : pairs) {
+        first[p.tail + 1]++;
+        first[p.head + 1]++;
+    }
+    for (size_t v = 1; v < first.size(); v++)
+        first[v] += first[v - 1];
+
+    int arcs = pairs.size() * 2;
+    heads.assign(arcs, 0);
+    mates.assign(arcs, 0);
+    capacities.assign(arcs, 0);
+    flows.assign(arcs, 0);
+    edges.assign(arcs, nullptr);
+    arcEnabled.assign(arcs, true);
+    vertexEnabled.assign(vertices.size(), true);
+    sourceArcs.assign(vertices.size(), -1);
+    sinkArcs.assign(vertices.size(), -1);
+
+    std::vector<int> next(first.begin(), first.end() - 1);
+    for (const Pair &p : pairs) {
+        int a = next[p.tail]++;
+        int b = next[p.head]++;
+        if (p.tail == source)
+            sourceArcs[p.head] = a;
+        else if (p.head == sink)
+            sinkArcs[p.tail] = a;
+        heads[a] = p.head;
+        heads[b] = p.tail;
+        mates[a] = b;
+        mates[b] = a;
+        capacities[a] = p.forward;
+        capacities[b] = p.backward;
+        edges[a] = p.forwardEdge;
+        edges[b] = p.backwardEdge;
+    }
+}
+
+/**
+ * Copies the flow stored in the Graph edges into the arcs.
+ * Arcs to the super source and sink get the flow that balances each vertex,
+ * which is whatever the vertex receives from or sends through its pipes.
+ * @note Complexity: O(E)
+*/
+inline void FlowNetwork::readFlows() {
+    int source = getSource();
+    for (int v = 0; v < source; v++) {
+        Capacity sent = 0;
+        int terminal = -1;
+        for (int a = begin(v); a < end(v); a++) {
+            if (heads[a] >= source) {
+                terminal = a;
+                continue;
+            }
+            Edge *forward = edges[a];
+            Edge *backward = edges[mates[a]];
+            flows[a] = (forward ? forward->getFlow() : 0) - (backward ? backward->getFlow() : 0);
+            sent += flows[a];
+        }
+        if (terminal != -1) {
+            flows[terminal] = -sent;
+            flows[mates[terminal]] = sent;
+        }
+    }
+}
+
+/**
+ * Copies the flow of the arcs back into the Graph edges.
+ * Only the edge in the direction the water is going gets a positive flow.
+ * @note Complexity: O(E)
+*/
+inline void FlowNetwork::writeFlows() const {
+    for (size_t a = 0; a < flows.size(); a++) {
+        if (edges[a] != nullptr)
+            edges[a]->setFlow(flows[a] > 0 ? flows[a] : 0);
+    }
+}
+
+#endif //FIRST_PROJECT_DA_FLOWNETWORK_H
@@ -0,0 +1,213 @@
+#ifndef FIRST_PROJECT_DA_GENERATOR_H
+#define FIRST_PROJECT_DA_GENERATOR_H
+
+#include "Manager.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Parameters of a random water network.
+*/
+struct GeneratorOptions {
+    int reservoirs = 5;
+    int stations = 100;
+    int cities = 20;
+    int pipes = 1000;
+    unsigned seed = 42;
+    double degreeSkew = 0;      // 0 spreads the pipes evenly, higher values give a few stations and cities most of them
+    double bidirectional = 0.3; // Fraction of the pipes between two stations that go both ways
+    double supplyRatio = 1.0;   // Total maximum delivery of the reservoirs over the total demand of the cities
+};
+
+/**
+ * Random water network, the same for the same options.
+ * Every station is fed by a reservoir or by a previous station and every city by a station,
+ * so all of them can get water. The remaining pipes join random elements: 10% leave a reservoir
+ * and the rest a station, 60% reach a station and the rest a city. No two pipes join the same
+ * pair of elements. The ends of the pipes are picked with a Zipf distribution of exponent degreeSkew
+ * over the stations and over the cities, in a random order.
+ * The network can be written in the CSV format of the bundled dataset or given to a manager.
+*/
+class NetworkGenerator {
+public:
+    NetworkGenerator(const GeneratorOptions &options);
+
+    size_t numPipes() const;
+    bool writeCsv(const std::string &directory) const;
+    void fill(Manager &manager) const;
+
+private:
+    struct CityRecord {
+        int demand;
+        int population;
+    };
+
+    struct PipeRecord {
+        int orig;
+        int dest;
+        int capacity;
+        bool bidirectional;
+    };
+
+    GeneratorOptions options;
+    std::vector<int> deliveries;
+    std::vector<CityRecord> cities;
+    std::vector<PipeRecord> pipes; // Ends numbered: reservoirs, then stations, then cities
+
+    std::string getCode(int element) const;
+};
+
+/**
+ * Generates the network.
+ * The pipes are drawn in rounds until there are enough of them without repeated pairs,
+ * so a network that cannot hold that many pipes gets fewer.
+ * @note Complexity: O(E log E + V)
+*/
+inline NetworkGenerator::NetworkGenerator(const GeneratorOptions &options) : options(options) {
+    this->options.reservoirs = std::max(1, options.reservoirs);
+    this->options.stations = std::max(1, options.stations);
+    this->options.cities = std::max(1, options.cities);
+    int numReservoirs = this->options.reservoirs, numStations = this->options.stations, numCities = this->options.cities;
+
+    std::mt19937 rng(options.seed);
+    auto random = [&rng](int low, int high) {
+        return std::uniform_int_distribution<int>(low, high)(rng);
+    };
+    auto skewed = [&rng, &options](int count) {
+        std::vector<int> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), rng);
+        std::vector<double> weights(count);
+        for (int i = 0; i < count; i++)
+            weights[order[i]] = 1 / std::pow(i + 1, options.degreeSkew);
+        return std::discrete_distribution<int>(weights.begin(), weights.end());
+    };
+    auto pickStation = skewed(numStations);
+    auto pickCity = skewed(numCities);
+    int firstStation = numReservoirs, firstCity = numReservoirs + numStations;
+
+    long totalDemand = 0;
+    for (int i = 0; i < numCities; i++) {
+        cities.push_back({random(10, 500), random(1000, 100000)});
+        totalDemand += cities.back().demand;
+    }
+    for (int i = 0; i < numReservoirs; i++)
+        deliveries.push_back(options.supplyRatio * totalDemand / numReservoirs * random(80, 120) / 100);
+
+    for (int i = 0; i < numStations; i++) {
+        int from = (i == 0 || random(0, 3) == 0) ? random(0, numReservoirs - 1) : firstStation + random(0, i - 1);
+        pipes.push_back({from, firstStation + i, random(100, 2000), false});
+    }
+    for (int i = 0; i < numCities; i++)
+        pipes.push_back({firstStation + pickStation(rng), firstCity + i, random(10, 1000), false});
+
+    auto pairOf = [](const PipeRecord &pipe) {
+        return std::make_pair(std::min(pipe.orig, pipe.dest), std::max(pipe.orig, pipe.dest));
+    };
+    for (int round = 0; round < 20 && (int)pipes.size() < options.pipes; round++) {
+        for (int missing = options.pipes - pipes.size(); missing > 0; missing--) {
+            int kind = random(0, 9);
+            int from = kind == 0 ? random(0, numReservoirs - 1) : firstStation + pickStation(rng);
+            int to = kind < 6 ? firstStation + pickStation(rng) : firstCity + pickCity(rng);
+            if (from == to)
+                continue;
+            bool both = kind > 0 && kind < 6 && std::bernoulli_distribution(options.bidirectional)(rng);
+            pipes.push_back({from, to, random(10, 1000), both});
+        }
+        // Keeps the first pipe of each pair, the ones feeding the stations and cities being the first
+        std::stable_sort(pipes.begin(), pipes.end(), [&pairOf](const PipeRecord &a, const PipeRecord &b) {
+            return pairOf(a) < pairOf(b);
+        });
+        pipes.erase(std::unique(pipes.begin(), pipes.end(), [&pairOf](const PipeRecord &a, const PipeRecord &b) {
+            return pairOf(a) == pairOf(b);
+        }), pipes.end());
+    }
+}
+
+inline size_t NetworkGenerator::numPipes() const {
+    return pipes.size();
+}
+
+/**
+ * Code of an element, in the format of the bundled dataset.
+*/
+inline std::string NetworkGenerator::getCode(int element) const {
+    if (element < options.reservoirs)
+        return "R_" + std::to_string(element + 1);
+    element -= options.reservoirs;
+    if (element < options.stations)
+        return "PS_" + std::to_string(element + 1);
+    return "C_" + std::to_string(element - options.stations + 1);
+}
+
+/**
+ * Writes the network as Reservoir.csv, Stations.csv, Cities.csv and Pipes.csv in a folder that must exist.
+ * @note Complexity: O(V + E)
+ * @return If every file could be written
+*/
+inline bool NetworkGenerator::writeCsv(const std::string &directory) const {
+    std::ofstream reservoirFile(directory + "/Reservoir.csv", std::ofstream::trunc);
+    reservoirFile << "Reservoir,Municipality,Id,Code,Maximum Delivery (m3/sec)\n";
+    for (int i = 0; i < options.reservoirs; i++)
+        reservoirFile << "Reservoir " << i + 1 << ",Nowhere," << i + 1 << "," << getCode(i) << "," << deliveries[i] << "\n";
+
+    std::ofstream stationFile(directory + "/Stations.csv", std::ofstream::trunc);
+    stationFile << "Id,Code\n";
+    for (int i = 0; i < options.stations; i++)
+        stationFile << i + 1 << "," << getCode(options.reservoirs + i) << "\n";
+
+    std::ofstream cityFile(directory + "/Cities.csv", std::ofstream::trunc);
+    cityFile << "City,Id,Code,Demand,Population\n";
+    for (int i = 0; i < options.cities; i++) {
+        cityFile << "City " << i + 1 << "," << i + 1 << "," << getCode(options.reservoirs + options.stations + i)
+                 << "," << cities[i].demand << "," << cities[i].population << "\n";
+    }
+
+    std::ofstream pipeFile(directory + "/Pipes.csv", std::ofstream::trunc);
+    pipeFile << "Service_Point_A,Service_Point_B,Capacity,Direction\n";
+    for (const PipeRecord &pipe : pipes)
+        pipeFile << getCode(pipe.orig) << "," << getCode(pipe.dest) << "," << pipe.capacity << "," << (pipe.bidirectional ? 0 : 1) << "\n";
+
+    reservoirFile.close();
+    stationFile.close();
+    cityFile.close();
+    pipeFile.close();
+    return reservoirFile && stationFile && cityFile && pipeFile;
+}
+
+/**
+ * Gives the network to an empty manager, like loading its CSV files.
+ * @note Complexity: O(V + E)
+*/
+inline void NetworkGenerator::fill(Manager &manager) const {
+    std::vector<Element *> elements;
+    manager.reserveElements(options.reservoirs, options.stations, options.cities);
+    for (int i = 0; i < options.reservoirs; i++) {
+        auto reservoir = manager.createReservoir(i + 1, getCode(i), "Reservoir " + std::to_string(i + 1), "Nowhere", deliveries[i]);
+        manager.reservoirs[reservoir->getCode()] = reservoir;
+        elements.push_back(reservoir);
+    }
+    for (int i = 0; i < options.stations; i++) {
+        auto station = manager.createStation(i + 1, getCode(options.reservoirs + i));
+        manager.stations[station->getCode()] = station;
+        elements.push_back(station);
+    }
+    for (int i = 0; i < options.cities; i++) {
+        auto city = manager.createCity(i + 1, getCode(options.reservoirs + options.stations + i), "City " + std::to_string(i + 1), cities[i].demand, cities[i].population);
+        manager.cities[city->getCode()] = city;
+        elements.push_back(city);
+    }
+    size_t edges = pipes.size() + std::count_if(pipes.begin(), pipes.end(), [](const PipeRecord &pipe) { return pipe.bidirectional; });
+    manager.network.reserve(elements.size(), edges);
+    for (Element *element : elements)
+        manager.addElement(element);
+    for (const PipeRecord &pipe : pipes)
+        manager.addPipe(elements[pipe.orig], elements[pipe.dest], pipe.capacity, pipe.bidirectional);
+}
+
+#endif //FIRST_PROJECT_DA_GENERATOR_H
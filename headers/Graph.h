@@ -7,29 +7,52 @@
 #include <limits>
 #include <algorithm>
 #include <unordered_map>
+#include <cstdint>
+#include <memory>
+#include "Capacity.h"
 #include "Element.h"
+#include "ObjectPool.h"
+#include "Span.h"
+#include "Stats.h"
 
-class Edge;
-class Vertex;
-class Graph;
+template <typename T> class BasicEdge;
+template <typename T> class BasicVertex;
+template <typename T> class BasicGraph;
+template <typename T> class BasicResidualArc;
+template <typename T> class BasicResidualArcs;
 
-#define INF std::numeric_limits<double>::max()
+typedef BasicEdge<Capacity> Edge;
+typedef BasicVertex<Capacity> Vertex;
+typedef BasicGraph<Capacity> Graph;
+typedef BasicResidualArc<Capacity> ResidualArc;
+
+#define INF std::numeric_limits<Capacity>::max()
 
 /************************* Vertex  **************************/
 
-class Vertex {
+/**
+ * Vertex of a graph whose capacities are of type T.
+ * Its outgoing edges are created in the edge pool of the graph.
+ * The lists of edges are read through views, which copy nothing.
+*/
+template <typename T>
+class BasicVertex {
 public:
-    Vertex(Element *in);
-    inline bool operator<(Vertex& vertex) const;
+    typedef BasicVertex<T> Vertex;
+    typedef BasicEdge<T> Edge;
+
+    BasicVertex(Element *in, ObjectPool<Edge> *edgePool);
+    inline bool operator<(BasicVertex& vertex) const;
 
     Element *getInfo() const;
-    std::vector<Edge *> getAdj() const;
+    Span<Edge *> getAdj() const;
     inline bool isVisited() const;
     inline bool isProcessing() const;
     unsigned int getIndegree() const;
     double getDist() const;
     Edge *getPath() const;
-    std::vector<Edge *> getIncoming() const;
+    Span<Edge *> getIncoming() const;
+    BasicResidualArcs<T> getResidualArcs() const;
 
     inline void setInfo(Element *info);
     inline void setVisited(bool visited);
@@ -37,12 +60,13 @@ public:
     inline void setIndegree(unsigned int indegree);
     inline void setDist(double dist);
     inline void setPath(Edge *path);
-    Edge *addEdge(Vertex *dest, double w);
+    Edge *addEdge(Vertex *dest, T w);
     inline bool removeEdge(Element *in);
     inline void removeOutgoingEdges();
 	
 protected:
     Element *info;
+    ObjectPool<Edge> *edgePool;
     std::vector<Edge *> adj;
 
     bool visited = false;
@@ -58,52 +82,133 @@ protected:
 
 /********************** Edge  ****************************/
 
-class Edge {
+/**
+ * Edge of a graph whose capacities are of type T.
+*/
+template <typename T>
+class BasicEdge {
 public:
-    Edge(Vertex *orig, Vertex *dest, double w);
+    typedef BasicVertex<T> Vertex;
+    typedef BasicEdge<T> Edge;
+
+    BasicEdge(Vertex *orig, Vertex *dest, T w);
 
     Vertex *getDest() const;
-    double getWeight() const;
+    T getWeight() const;
     inline bool isSelected() const;
     Vertex *getOrig() const;
     Edge *getReverse() const;
-    double getFlow() const;
+    T getFlow() const;
 
     inline void setSelected(bool selected);
     inline void setReverse(Edge *reverse);
-    inline void setFlow(double flow);
+    inline void setFlow(T flow);
+    inline void setWeight(T weight);
 	
 protected:
 	Vertex *orig;
     Vertex *dest;
-    double weight;
+    T weight;
 
     bool selected = false;
     Edge *reverse = nullptr;
 
-    double flow;
+    T flow = 0;
+};
+
+/********************** Residual arcs  ****************************/
+
+/**
+ * Arc of the residual graph leaving a vertex: an outgoing edge followed forward,
+ * or an incoming edge followed backwards to cancel its flow.
+*/
+template <typename T>
+class BasicResidualArc {
+public:
+    typedef BasicVertex<T> Vertex;
+    typedef BasicEdge<T> Edge;
+
+    BasicResidualArc(Edge *edge, bool forward);
+
+    Edge *getEdge() const;
+    inline bool isForward() const;
+    Vertex *getOther() const;
+    T getResidual() const;
+
+protected:
+    Edge *edge;
+    bool forward;
+};
+
+/**
+ * Residual arcs leaving a vertex, the outgoing edges first and then the incoming ones,
+ * read in place from the lists of the vertex.
+*/
+template <typename T>
+class BasicResidualArcs {
+public:
+    typedef BasicEdge<T> Edge;
+
+    class Iterator {
+    public:
+        Iterator(Span<Edge *> outgoing, Span<Edge *> incoming, bool atEnd);
+        BasicResidualArc<T> operator*() const;
+        Iterator &operator++();
+        bool operator!=(const Iterator &other) const;
+
+    private:
+        Edge *const *current;
+        Edge *const *outgoingEnd;
+        Edge *const *incomingBegin;
+        bool forward;
+    };
+
+    BasicResidualArcs(Span<Edge *> outgoing, Span<Edge *> incoming);
+
+    Iterator begin() const;
+    Iterator end() const;
+    size_t size() const;
+
+protected:
+    Span<Edge *> outgoing;
+    Span<Edge *> incoming;
 };
 
 /********************** Graph  ****************************/
 
-class Graph {
+/**
+ * Graph whose capacities are of type T.
+ * Its vertices and edges live in pools owned by the graph, so they are next to each other
+ * in memory and all freed at once with the graph. A graph can be moved but not copied.
+*/
+template <typename T>
+class BasicGraph {
 public:
-    ~Graph();
+    typedef BasicVertex<T> Vertex;
+    typedef BasicEdge<T> Edge;
+
+    BasicGraph();
+    ~BasicGraph();
+    BasicGraph(BasicGraph &&) = default;
+    BasicGraph &operator=(BasicGraph &&) = default;
 
-    Vertex *findVertex(Element *in) const;
-	Vertex *findVertexByCode(std::string code) const;
+    Vertex *findVertex(const Element *in) const;
+	Vertex *findVertexByCode(const std::string &code) const;
     inline bool addVertex(Element *in);
-    inline bool removeVertex(Element *in);
 
-    inline bool addEdge(Element *sourc, Element *dest, double w);
+    inline bool addEdge(Element *sourc, Element *dest, T w);
     inline bool removeEdge(Element *source, Element *dest);
-    inline bool addBidirectionalEdge(Element *sourc, Element *dest, double w);
+    inline bool addBidirectionalEdge(Element *sourc, Element *dest, T w);
 
     int getNumVertex() const;
-    std::vector<Vertex *> getVertexSet() const;
-	Graph getCopy();
+    Span<Vertex *> getVertexSet() const;
+    void reserve(size_t vertices, size_t edges);
 protected:
+    // Behind pointers so the vertices keep pointing at the edge pool when the graph is moved
+    std::unique_ptr<ObjectPool<Vertex>> vertexPool;
+    std::unique_ptr<ObjectPool<Edge>> edgePool;
     std::vector<Vertex *> vertexSet;
+    std::vector<Vertex *> vertexByIndex; // Indexed by the dense index of the elements, nullptr for the missing ones
 	std::unordered_map<std::string, Vertex *> vertexMap;
 
     double ** distMatrix = nullptr;
@@ -112,38 +217,18 @@ protected:
     int findVertexIdx(const Element *in) const;
 };
 
-/**
- * Creates a copy of the graph
- * @note Complexity: O(V + E)
-*/
-inline Graph Graph::getCopy()
-{
-	Graph result;
-
-	for (auto i : vertexSet)
-	{
-		result.addVertex(i->getInfo());
-	}
-
-	for (auto i : vertexSet)
-	{
-		for (auto j : i->getAdj())
-		{
-			result.addEdge(i->getInfo(), j->getDest()->getInfo(), j->getWeight());
-		}
-	}
-	return result;
-}
-
 /************************* Vertex  **************************/
 
-inline Vertex::Vertex(Element *in) : info(in) {}
+template <typename T>
+inline BasicVertex<T>::BasicVertex(Element *in, ObjectPool<Edge> *edgePool) : info(in), edgePool(edgePool) {}
 /*
  * Auxiliary function to add an outgoing edge to a vertex (this),
  * with a given destination vertex (d) and edge weight (w).
 */
-inline Edge *Vertex::addEdge(Vertex *d, double w) {
-    auto newEdge = new Edge(this, d, w);
+template <typename T>
+inline BasicEdge<T> *BasicVertex<T>::addEdge(BasicVertex<T> *d, T w) {
+    auto newEdge = edgePool->create(this, d, w);
+    STATS_ADD(BytesAllocated, sizeof(Edge));
     adj.push_back(newEdge);
     d->incoming.push_back(newEdge);
     return newEdge;
@@ -154,7 +239,8 @@ inline Edge *Vertex::addEdge(Vertex *d, double w) {
  * from a vertex (this).
  * Returns true if successful, and false if such edge does not exist.
  */
-inline bool Vertex::removeEdge(Element *in) {
+template <typename T>
+inline bool BasicVertex<T>::removeEdge(Element *in) {
     bool removedEdge = false;
     auto it = adj.begin();
     while (it != adj.end()) {
@@ -175,76 +261,99 @@ inline bool Vertex::removeEdge(Element *in) {
 /*
  * Auxiliary function to remove an outgoing edge of a vertex.
  */
-inline void Vertex::removeOutgoingEdges() {
-    auto it = adj.begin();
-    while (it != adj.end()) {
-        Edge *edge = *it;
-        it = adj.erase(it);
+template <typename T>
+inline void BasicVertex<T>::removeOutgoingEdges() {
+    for (Edge *edge : adj)
         deleteEdge(edge);
-    }
+    adj.clear();
 }
 
-inline bool Vertex::operator<(Vertex & vertex) const {
+template <typename T>
+inline bool BasicVertex<T>::operator<(Vertex & vertex) const {
     return this->dist < vertex.dist;
 }
 
-inline Element *Vertex::getInfo() const {
+template <typename T>
+inline Element *BasicVertex<T>::getInfo() const {
     return this->info;
 }
 
-inline std::vector<Edge *> Vertex::getAdj() const {
+template <typename T>
+inline Span<BasicEdge<T> *> BasicVertex<T>::getAdj() const {
     return this->adj;
 }
 
-inline bool Vertex::isVisited() const {
+template <typename T>
+inline bool BasicVertex<T>::isVisited() const {
     return this->visited;
 }
 
-inline bool Vertex::isProcessing() const {
+template <typename T>
+inline bool BasicVertex<T>::isProcessing() const {
     return this->processing;
 }
 
-inline unsigned int Vertex::getIndegree() const {
+template <typename T>
+inline unsigned int BasicVertex<T>::getIndegree() const {
     return this->indegree;
 }
 
-inline double Vertex::getDist() const {
+template <typename T>
+inline double BasicVertex<T>::getDist() const {
     return this->dist;
 }
 
-inline Edge *Vertex::getPath() const {
+template <typename T>
+inline BasicEdge<T> *BasicVertex<T>::getPath() const {
     return this->path;
 }
 
-inline std::vector<Edge *> Vertex::getIncoming() const {
+template <typename T>
+inline Span<BasicEdge<T> *> BasicVertex<T>::getIncoming() const {
     return this->incoming;
 }
 
-inline void Vertex::setInfo(Element *in) {
+/**
+ * Arcs of the residual graph leaving the vertex: its outgoing edges, then its incoming edges backwards.
+ * @note Complexity: O(1)
+*/
+template <typename T>
+inline BasicResidualArcs<T> BasicVertex<T>::getResidualArcs() const {
+    return BasicResidualArcs<T>(this->adj, this->incoming);
+}
+
+template <typename T>
+inline void BasicVertex<T>::setInfo(Element *in) {
     this->info = in;
 }
 
-inline void Vertex::setVisited(bool visited) {
+template <typename T>
+inline void BasicVertex<T>::setVisited(bool visited) {
     this->visited = visited;
 }
 
-inline void Vertex::setProcesssing(bool processing) {
+template <typename T>
+inline void BasicVertex<T>::setProcesssing(bool processing) {
     this->processing = processing;
 }
 
-inline void Vertex::setIndegree(unsigned int indegree) {
+template <typename T>
+inline void BasicVertex<T>::setIndegree(unsigned int indegree) {
     this->indegree = indegree;
 }
 
-inline void Vertex::setDist(double dist) {
+template <typename T>
+inline void BasicVertex<T>::setDist(double dist) {
     this->dist = dist;
 }
 
-inline void Vertex::setPath(Edge *path) {
+template <typename T>
+inline void BasicVertex<T>::setPath(Edge *path) {
     this->path = path;
 }
 
-inline void Vertex::deleteEdge(Edge *edge) {
+template <typename T>
+inline void BasicVertex<T>::deleteEdge(Edge *edge) {
     Vertex *dest = edge->getDest();
     // Remove the corresponding edge from the incoming list
     auto it = dest->incoming.begin();
@@ -256,86 +365,211 @@ inline void Vertex::deleteEdge(Edge *edge) {
             it++;
         }
     }
-    delete edge;
+    edgePool->destroy(edge);
 }
 
 /********************** Edge  ****************************/
 
-inline Edge::Edge(Vertex *orig, Vertex *dest, double w): orig(orig), dest(dest), weight(w) {}
+template <typename T>
+inline BasicEdge<T>::BasicEdge(Vertex *orig, Vertex *dest, T w): orig(orig), dest(dest), weight(w) {}
 
-inline Vertex *Edge::getDest() const {
+template <typename T>
+inline BasicVertex<T> *BasicEdge<T>::getDest() const {
     return this->dest;
 }
 
-inline double Edge::getWeight() const {
+template <typename T>
+inline T BasicEdge<T>::getWeight() const {
     return this->weight;
 }
 
-inline Vertex *Edge::getOrig() const {
+template <typename T>
+inline BasicVertex<T> *BasicEdge<T>::getOrig() const {
     return this->orig;
 }
 
-inline Edge *Edge::getReverse() const {
+template <typename T>
+inline BasicEdge<T> *BasicEdge<T>::getReverse() const {
     return this->reverse;
 }
 
-inline bool Edge::isSelected() const {
+template <typename T>
+inline bool BasicEdge<T>::isSelected() const {
     return this->selected;
 }
 
-inline double Edge::getFlow() const {
+template <typename T>
+inline T BasicEdge<T>::getFlow() const {
     return flow;
 }
 
-inline void Edge::setSelected(bool selected) {
+template <typename T>
+inline void BasicEdge<T>::setSelected(bool selected) {
     this->selected = selected;
 }
 
-inline void Edge::setReverse(Edge *reverse) {
+template <typename T>
+inline void BasicEdge<T>::setReverse(Edge *reverse) {
     this->reverse = reverse;
 }
 
-inline void Edge::setFlow(double flow) {
+template <typename T>
+inline void BasicEdge<T>::setFlow(T flow) {
     this->flow = flow;
 }
 
+template <typename T>
+inline void BasicEdge<T>::setWeight(T weight) {
+    this->weight = weight;
+}
+
+/********************** Residual arcs  ****************************/
+
+template <typename T>
+inline BasicResidualArc<T>::BasicResidualArc(Edge *edge, bool forward) : edge(edge), forward(forward) {}
+
+template <typename T>
+inline BasicEdge<T> *BasicResidualArc<T>::getEdge() const {
+    return this->edge;
+}
+
+template <typename T>
+inline bool BasicResidualArc<T>::isForward() const {
+    return this->forward;
+}
+
+/**
+ * Vertex the arc leads to: the destination of a forward edge, the origin of a backward one.
+*/
+template <typename T>
+inline BasicVertex<T> *BasicResidualArc<T>::getOther() const {
+    return forward ? edge->getDest() : edge->getOrig();
+}
+
+/**
+ * Flow the arc may still carry: the free capacity of a forward edge, the flow of a backward one.
+*/
+template <typename T>
+inline T BasicResidualArc<T>::getResidual() const {
+    return forward ? edge->getWeight() - edge->getFlow() : edge->getFlow();
+}
+
+template <typename T>
+inline BasicResidualArcs<T>::BasicResidualArcs(Span<Edge *> outgoing, Span<Edge *> incoming)
+    : outgoing(outgoing), incoming(incoming) {}
+
+template <typename T>
+inline typename BasicResidualArcs<T>::Iterator BasicResidualArcs<T>::begin() const {
+    return Iterator(outgoing, incoming, false);
+}
+
+template <typename T>
+inline typename BasicResidualArcs<T>::Iterator BasicResidualArcs<T>::end() const {
+    return Iterator(outgoing, incoming, true);
+}
+
+template <typename T>
+inline size_t BasicResidualArcs<T>::size() const {
+    return outgoing.size() + incoming.size();
+}
+
+/*
+ * The iterator never rests at the end of the outgoing edges: it goes on to the incoming ones,
+ * so two iterators are equal when they point at the same edge in the same direction.
+ */
+template <typename T>
+inline BasicResidualArcs<T>::Iterator::Iterator(Span<Edge *> outgoing, Span<Edge *> incoming, bool atEnd)
+    : current(atEnd ? incoming.end() : outgoing.begin()), outgoingEnd(outgoing.end()),
+      incomingBegin(incoming.begin()), forward(!atEnd) {
+    if (forward && current == outgoingEnd) {
+        current = incomingBegin;
+        forward = false;
+    }
+}
+
+template <typename T>
+inline BasicResidualArc<T> BasicResidualArcs<T>::Iterator::operator*() const {
+    return BasicResidualArc<T>(*current, forward);
+}
+
+template <typename T>
+inline typename BasicResidualArcs<T>::Iterator &BasicResidualArcs<T>::Iterator::operator++() {
+    if (++current == outgoingEnd && forward) {
+        current = incomingBegin;
+        forward = false;
+    }
+    return *this;
+}
+
+template <typename T>
+inline bool BasicResidualArcs<T>::Iterator::operator!=(const Iterator &other) const {
+    return current != other.current || forward != other.forward;
+}
+
 /********************** Graph  ****************************/
 
-inline Graph::~Graph() {}
+template <typename T>
+inline BasicGraph<T>::BasicGraph() : vertexPool(new ObjectPool<Vertex>()), edgePool(new ObjectPool<Edge>()) {}
+
+/**
+ * Frees every vertex and edge of the graph at once, with their pools.
+*/
+template <typename T>
+inline BasicGraph<T>::~BasicGraph() {}
+
+/**
+ * Makes room for a number of vertices and edges, so adding them allocates them next to each other.
+ * @note Complexity: O(1)
+*/
+template <typename T>
+inline void BasicGraph<T>::reserve(size_t vertices, size_t edges) {
+    vertexPool->reserve(vertices);
+    edgePool->reserve(edges);
+    vertexSet.reserve(vertices);
+}
 
-inline int Graph::getNumVertex() const {
+template <typename T>
+inline int BasicGraph<T>::getNumVertex() const {
     return vertexSet.size();
 }
 
-inline std::vector<Vertex *> Graph::getVertexSet() const {
+template <typename T>
+inline Span<BasicVertex<T> *> BasicGraph<T>::getVertexSet() const {
     return vertexSet;
 }
 
-inline Vertex *Graph::findVertexByCode(std::string code) const {
-	try
-	{
-		return vertexMap.at(code);
-	}
-	catch(const std::exception& e)
-	{
-		return nullptr;
-	}
+/*
+ * Finds the vertex of the element with a given code.
+ * Meant for codes typed by the user, everything else uses findVertex.
+ */
+template <typename T>
+inline BasicVertex<T> *BasicGraph<T>::findVertexByCode(const std::string &code) const {
+	STATS_ADD(VertexLookups, 1);
+	auto it = vertexMap.find(code);
+	return it == vertexMap.end() ? nullptr : it->second;
 }
 
 /*
- * Auxiliary function to find a vertex with a given content.
+ * Auxiliary function to find a vertex with a given content, through the index of the element.
+ * Returns nullptr if there is no content or it is not in the graph.
+ * @note Complexity: O(1)
  */
-inline Vertex *Graph::findVertex(Element *in) const {
-	for (auto v : vertexSet)
-        if (v->getInfo() == in)
-            return v;
-    return nullptr;
+template <typename T>
+inline BasicVertex<T> *BasicGraph<T>::findVertex(const Element *in) const {
+	STATS_ADD(VertexLookups, 1);
+	if (in == nullptr)
+		return nullptr;
+	int index = in->getIndex();
+	if (index < 0 || index >= (int)vertexByIndex.size())
+		return nullptr;
+	return vertexByIndex[index];
 }
 
 /*
  * Finds the index of the vertex with a given content.
  */
-inline int Graph::findVertexIdx(const Element *in) const {
+template <typename T>
+inline int BasicGraph<T>::findVertexIdx(const Element *in) const {
     for (unsigned i = 0; i < vertexSet.size(); i++)
         if (vertexSet[i]->getInfo() == in)
             return i;
@@ -343,48 +577,35 @@ inline int Graph::findVertexIdx(const Element *in) const {
 }
 /*
  *  Adds a vertex with a given content or info (in) to a graph (this).
+ *  An element without an index yet gets the first one not used in the graph.
  *  Returns true if successful, and false if a vertex with that content already exists.
  */
-inline bool Graph::addVertex(Element *in) {
+template <typename T>
+inline bool BasicGraph<T>::addVertex(Element *in) {
 	if (findVertex(in) != nullptr)
     	return false;
+	if (in->getIndex() < 0)
+		in->setIndex(vertexByIndex.size());
 	
-	Vertex *vtx = new Vertex(in);
+	Vertex *vtx = vertexPool->create(in, edgePool.get());
+	STATS_ADD(BytesAllocated, sizeof(Vertex));
 	vertexMap[in->getCode()] = vtx;
 	vertexSet.push_back(vtx);
+	if (in->getIndex() >= (int)vertexByIndex.size())
+		vertexByIndex.resize(in->getIndex() + 1, nullptr);
+	vertexByIndex[in->getIndex()] = vtx;
 	return true;
 }
 
-/*
- *  Removes a vertex with a given content (in) from a graph (this), and
- *  all outgoing and incoming edges.
- *  Returns true if successful, and false if such vertex does not exist.
- */
-inline bool Graph::removeVertex(Element *in) {
-    for (auto it = vertexSet.begin(); it != vertexSet.end(); it++) {
-        if ((*it)->getInfo() == in) {
-            auto v = *it;
-            v->removeOutgoingEdges();
-            for (auto u : vertexSet) {
-                u->removeEdge(v->getInfo());
-            }
-			vertexMap.erase(v->getInfo()->getCode());
-            vertexSet.erase(it);
-            delete v;
-            return true;
-        }
-    }
-    return false;
-}
-
 /*
  * Adds an edge to a graph (this), given the contents of the source and
  * destination vertices and the edge weight (w).
  * Returns true if successful, and false if the source or destination vertex does not exist.
  */
-inline bool Graph::addEdge(Element *sourc, Element *dest, double w) {
-    auto v1 = findVertexByCode(sourc->getCode());
-    auto v2 = findVertexByCode(dest->getCode());
+template <typename T>
+inline bool BasicGraph<T>::addEdge(Element *sourc, Element *dest, T w) {
+    auto v1 = findVertex(sourc);
+    auto v2 = findVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
     v1->addEdge(v2, w);
@@ -396,17 +617,19 @@ inline bool Graph::addEdge(Element *sourc, Element *dest, double w) {
  * The edge is identified by the source (sourc) and destination (dest) contents.
  * Returns true if successful, and false if such edge does not exist.
  */
-inline bool Graph::removeEdge(Element *sourc, Element *dest) {
-    Vertex* srcVertex = findVertexByCode(sourc->getCode());
+template <typename T>
+inline bool BasicGraph<T>::removeEdge(Element *sourc, Element *dest) {
+    Vertex* srcVertex = findVertex(sourc);
     if (srcVertex == nullptr) {
         return false;
     }
     return srcVertex->removeEdge(dest);
 }
 
-inline bool Graph::addBidirectionalEdge(Element *sourc, Element *dest, double w) {
-    auto v1 = findVertexByCode(sourc->getCode());
-    auto v2 = findVertexByCode(dest->getCode());
+template <typename T>
+inline bool BasicGraph<T>::addBidirectionalEdge(Element *sourc, Element *dest, T w) {
+    auto v1 = findVertex(sourc);
+    auto v2 = findVertex(dest);
     if (v1 == nullptr || v2 == nullptr)
         return false;
     auto e1 = v1->addEdge(v2, w);
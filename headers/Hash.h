@@ -0,0 +1,32 @@
+#ifndef FIRST_PROJECT_DA_HASH_H
+#define FIRST_PROJECT_DA_HASH_H
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * FNV-1a hash of some bytes, continuing from a previous hash.
+ * @note Complexity: O(n) where n is the number of bytes
+*/
+inline uint64_t fnv1a(std::string_view data, uint64_t hash = FNV_OFFSET) {
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * FNV-1a hash of the bytes of a number, continuing from a previous hash.
+ * Strings go to the overload above, so their text is hashed and not the object.
+*/
+template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+inline uint64_t fnv1a(T value, uint64_t hash) {
+    return fnv1a(std::string_view(reinterpret_cast<const char *>(&value), sizeof(value)), hash);
+}
+
+#endif //FIRST_PROJECT_DA_HASH_H
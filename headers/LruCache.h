@@ -0,0 +1,141 @@
+#ifndef FIRST_PROJECT_DA_LRUCACHE_H
+#define FIRST_PROJECT_DA_LRUCACHE_H
+
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * Map holding at most a fixed number of values, shared between threads.
+ * When it is full, put drops the value that was used the longest time ago,
+ * while tryPut leaves it unchanged.
+*/
+template <typename Key, typename Value>
+class LruCache {
+public:
+    LruCache(size_t capacity = 0);
+
+    void setCapacity(size_t capacity);
+    bool get(const Key &key, Value &value);
+    bool contains(const Key &key);
+    void put(const Key &key, const Value &value);
+    bool tryPut(const Key &key, const Value &value);
+    bool full();
+    size_t size();
+    void clear();
+
+private:
+    typedef std::list<std::pair<Key, Value>> Entries;
+
+    size_t capacity;
+    Entries entries; // Most recently used first
+    std::unordered_map<Key, typename Entries::iterator> index;
+    std::mutex mutex;
+};
+
+/**
+ * @param capacity Maximum number of values, 0 for no limit
+*/
+template <typename Key, typename Value>
+inline LruCache<Key, Value>::LruCache(size_t capacity) : capacity(capacity) {}
+
+/**
+ * Changes the maximum number of values, dropping the least recently used ones if needed.
+ * @param capacity Maximum number of values, 0 for no limit
+*/
+template <typename Key, typename Value>
+inline void LruCache<Key, Value>::setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->capacity = capacity;
+    while (capacity != 0 && entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+/**
+ * Copies the value of a key and marks it as the most recently used.
+ * @note Complexity: O(1) on average
+ * @return If the key was found
+*/
+template <typename Key, typename Value>
+inline bool LruCache<Key, Value>::get(const Key &key, Value &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end())
+        return false;
+    entries.splice(entries.begin(), entries, it->second);
+    value = it->second->second;
+    return true;
+}
+
+/**
+ * @note Complexity: O(1) on average
+*/
+template <typename Key, typename Value>
+inline bool LruCache<Key, Value>::contains(const Key &key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.find(key) != index.end();
+}
+
+/**
+ * Saves the value of a key as the most recently used one,
+ * dropping the least recently used value when the cache is full.
+ * @note Complexity: O(1) on average
+*/
+template <typename Key, typename Value>
+inline void LruCache<Key, Value>::put(const Key &key, const Value &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = value;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (capacity != 0 && entries.size() == capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, value);
+    index[key] = entries.begin();
+}
+
+/**
+ * Saves the value of a key, as the least recently used one, only if the cache has room for it.
+ * @note Complexity: O(1) on average
+ * @return If the key is in the cache afterwards
+*/
+template <typename Key, typename Value>
+inline bool LruCache<Key, Value>::tryPut(const Key &key, const Value &value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.find(key) != index.end())
+        return true;
+    if (capacity != 0 && entries.size() >= capacity)
+        return false;
+    entries.emplace_back(key, value);
+    index[key] = std::prev(entries.end());
+    return true;
+}
+
+template <typename Key, typename Value>
+inline bool LruCache<Key, Value>::full() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity != 0 && entries.size() >= capacity;
+}
+
+template <typename Key, typename Value>
+inline size_t LruCache<Key, Value>::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+template <typename Key, typename Value>
+inline void LruCache<Key, Value>::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+#endif //FIRST_PROJECT_DA_LRUCACHE_H
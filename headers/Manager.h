@@ -2,17 +2,64 @@
 #define FIRST_PROJECT_DA_MANAGER_H
 
 #include "Graph.h"
+#include "FlowNetwork.h"
+#include "EpochMarks.h"
 #include "City.h"
 #include "Reservoir.h"
 #include "Station.h"
+#include "LruCache.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <memory>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
 
-typedef std::unordered_map<std::string, int> FlowComb;
+typedef std::vector<std::pair<int, Capacity>> FlowComb; // Index of a city and its flow
 typedef std::tuple<double, double, double> AnaliseResult;
-typedef std::unordered_map<std::string, std::unordered_map<std::string, int>> RmResult;
+typedef std::unordered_map<uint64_t, FlowComb> RmResult; // By pipe key (Manager::getPipeKey)
+typedef std::tuple<int, int, Capacity> CityCheck; // City index, vertex in the residual graph, flow
+
+/**
+ * State of the breadth-first searches of EdmondsBFS, kept from one search to the next
+ * so each search only touches the vertices it reaches.
+ * Each thread has one (PathSearch::get), reused by every residual graph it works on.
+*/
+struct PathSearch {
+    std::vector<int> path; // Arc used to reach each vertex, only valid for the reached ones
+    EpochMarks reached;
+    std::vector<std::pair<int, Capacity>> queue;
+
+    static PathSearch &get(int numVertex);
+};
+
+/**
+ * Search state of the calling thread, with room for a number of vertices.
+ * @note Complexity: O(1) unless the residual graph is bigger than any before it in the thread
+*/
+inline PathSearch &PathSearch::get(int numVertex)
+{
+    thread_local PathSearch search;
+    if ((int)search.path.size() < numVertex){
+        search.path.resize(numVertex);
+        search.reached.resize(numVertex);
+    }
+    return search;
+}
+
+/**
+ * Algorithms available to calculate the max flow of the network.
+*/
+enum class FlowAlgorithm {
+	EdmondsKarp,
+	Dinic,
+	PushRelabel,
+	ParallelPushRelabel
+};
 
 /**
  * Class containg all the information and methods the manipulate it.
@@ -22,62 +69,124 @@ class Manager {
     private:
 		bool useSmallSet;
         double numberEdges = 0;
+        bool lazyReliability = false;
+        LruCache<uint64_t, FlowComb> failureMemo; // Results of the lazy reliability analysis, by pipe or station key
+        FlowNetwork workspace; // Copy of the residual graph reused to simulate one failure at a time
+        std::unique_ptr<ThreadPool> pool; // Workers of the analyses, started by the first one
+        std::vector<FlowNetwork> workspaces; // Copy of the residual graph of each worker of the pool
+        ObjectPool<Reservoir> reservoirPool; // The elements, all freed at once with the manager
+        ObjectPool<Station> stationPool;
+        ObjectPool<City> cityPool;
+        EpochMarks pathMarks; // Vertices given a path by the current search of FarthestAugmentingPath, by element index
+        std::thread prefetcher;
+        std::atomic<bool> stopPrefetching{false};
+        std::atomic<bool> cancelled{false}; // Set by cancelAnalyses, the failures left are skipped
 
     public:
-		double totalNetworkFlow = -1;
-		FlowComb maxFlows;
-        FlowComb deficitcities;
-        RmResult rmPS;
+		FlowAlgorithm algorithm = FlowAlgorithm::EdmondsKarp;
+		int parallelThreshold = 100000; // Vertices from which the parallel solver is used, 0 to never switch
+		unsigned maxThreads = 0; // Threads used by the parallel solver and analyses, 0 to use all available
+		std::string datasetDir; // Folder with the CSV files to load, empty for the bundled dataset
+		Capacity totalNetworkFlow = -1;
+		std::vector<Capacity> maxFlows; // Flow of each city, by element index
+        std::vector<Capacity> deficitcities; // Missing flow of each city, by element index, 0 when its demand is met
+        std::vector<FlowComb> rmPS; // Affected cities of each station, by element index
         RmResult rmPipelines;
 
 		Graph network;
+		FlowNetwork flowNetwork;
         std::unordered_map<std::string, Reservoir *> reservoirs;
         std::unordered_map<std::string, Station *> stations;
         std::unordered_map<std::string, City *> cities;
 		std::unordered_map<std::string, Element *> allElements;
+		std::vector<Element *> elementsById;
 
 		inline Manager(bool useSmallSet) : useSmallSet(useSmallSet) {};
 		~Manager();
 
         // Loaders
+        Reservoir *createReservoir(int id, const std::string &code, const std::string &name, const std::string &municipality, Capacity maxDelivery);
+        Station *createStation(int id, const std::string &code);
+        City *createCity(int id, const std::string &code, const std::string &name, Capacity demand, int population);
+        void reserveElements(size_t reservoirs, size_t stations, size_t cities);
+        void addElement(Element *element);
+        bool addPipe(Element *orig, Element *dest, Capacity capacity, bool bidirectional);
         void loadReservoirs();
         void loadStations();
         void loadCities();
         void loadPipes();
+        bool saveSnapshot(const std::string &path);
+        bool loadSnapshot(const std::string &path);
 
         // Basic Service Metrics
-        double CalculateMaxFlow(Graph &network);
+        Capacity CalculateMaxFlow(Graph &network);
         void maxFlowCities();
         void citiesInDeficit();
         std::pair<AnaliseResult, AnaliseResult> balanceNetwork();
 
+        // Updates
+        void updatePipeCapacity(Edge *pipe, Capacity capacity);
+        void updateMaxDelivery(Reservoir *reservoir, Capacity maxDelivery);
+        void updateDemand(City *city, Capacity demand);
+
         // Reliability
-        std::vector<std::tuple<Vertex *, double, double>> removeReservoir(Reservoir* reservoir);
+        std::vector<std::tuple<Vertex *, Capacity, Capacity>> removeReservoir(Reservoir* reservoir);
         void maintenancePS();
         void maintenancePipes();
+        void reliabilityAnalysis(const std::string &cachePath);
+        void startLazyReliability(size_t memoCapacity);
+        void refreshReliability();
+        void stopPrefetch();
+        void cancelAnalyses();
+        FlowComb pipeFailure(Edge *pipe);
+        std::vector<Edge*> listReportedPipes();
+        FlowComb stationFailure(Station *station);
+        std::vector<Edge*> listPipes();
+        std::string getPipeCode(Edge *pipe);
+        uint64_t getPipeKey(Edge *pipe);
+        FlowComb listCities(const std::vector<Capacity> &values, bool skipZero) const;
 
     private:
-        double FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& last);
-        void EdmondsKarp(Graph &network, Element* source, Element* target, const std::unordered_set<Vertex*>& affected);
-        double EdmondsBFS(Graph &network, Vertex* source, Vertex* target, const std::unordered_set<Vertex*>& affected);
+        Capacity FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& last);
+        unsigned getThreads() const;
+        ThreadPool &getPool();
+        void buildFlowNetwork(Graph &network, FlowNetwork &flow);
+        std::vector<FlowComb> analyseOutages(size_t count, const std::function<void(FlowNetwork &flow, size_t index, bool enabled)> &setEnabled,
+                                             const std::function<std::string(size_t index)> &describe);
+        Capacity MaxFlow(FlowNetwork &flow, int source, int target, unsigned threads);
+        Capacity EdmondsKarp(FlowNetwork &flow, int source, int target);
+        Capacity EdmondsBFS(FlowNetwork &flow, int source, int target, PathSearch &search);
+        Capacity Dinic(FlowNetwork &flow, int source, int target);
+        bool DinicBFS(FlowNetwork &flow, int source, int target, std::vector<int> &level);
+        Capacity DinicBlockingFlow(FlowNetwork &flow, int source, int target, const std::vector<int> &level, std::vector<int> &current);
+        Capacity PushRelabel(FlowNetwork &flow, int source, int target);
+        Capacity ParallelPushRelabel(FlowNetwork &flow, int source, int target, unsigned threads);
+        Capacity RepairFlow(FlowNetwork &flow, int source, int target);
+        Capacity SendFlow(FlowNetwork &flow, int from, int to, Capacity amount, PathSearch &search);
+        bool updateCapacity(int arc, Capacity capacity);
+        void repairMaxFlow(bool cancel);
+        void readCityFlows();
+        std::vector<CityCheck> getCitiesToCheck();
+        FlowComb simulateOutage(FlowNetwork &flow, const FlowNetwork &base, const std::vector<CityCheck> &citiesToCheck,
+                                const std::function<void(FlowNetwork &flow, bool enabled)> &setEnabled);
+        FlowComb lookupFailure(uint64_t key, const std::function<std::string()> &describe,
+                               const std::function<void(FlowNetwork &flow, bool enabled)> &setEnabled);
+        void startPrefetch();
+        void analysePipes(const std::vector<Edge*> &pipes);
+        void analyseStations(const std::vector<Station*> &stationList);
+        uint64_t hashDataset() const;
+        std::vector<uint64_t> hashComponents(std::vector<int> &component);
         std::tuple<double, double, double> AnalyzeBalance();
 };
 
 /**
  * Destructor for the manager class.
- * Erases all allocated memory, including the one allocated by the Graph class.
+ * The elements are freed with their pools and the vertices and edges with the graph.
+ * The prefetcher of the lazy reliability analysis is stopped first.
 */
 inline Manager::~Manager()
 {
-	for (const auto& [code, e] : allElements)
-		delete e;
-	for (auto vtx : network.getVertexSet())
-	{
-		for (auto edg : vtx->getAdj())
-			delete edg;
-		delete vtx;
-	}
-		
+	stopPrefetch();
 }
 
 #endif //FIRST_PROJECT_DA_MANAGER_H
@@ -0,0 +1,172 @@
+#ifndef FIRST_PROJECT_DA_MAPPEDFILE_H
+#define FIRST_PROJECT_DA_MAPPEDFILE_H
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include "Capacity.h"
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+/**
+ * Read-only view of a whole file.
+ * On unix systems the file is memory mapped, elsewhere it is read into memory.
+*/
+class MappedFile {
+public:
+    MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const;
+    std::string_view getText() const;
+
+private:
+    bool opened = false;
+    std::string_view text;
+#ifdef __unix__
+    void *mapping = nullptr;
+#else
+    std::string buffer;
+#endif
+};
+
+/**
+ * Opens and maps a file. isOpen tells if it worked.
+ * An empty file is open, with no text.
+*/
+inline MappedFile::MappedFile(const std::string &path) {
+#ifdef __unix__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return;
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        opened = true;
+        if (info.st_size > 0) {
+            mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                mapping = nullptr;
+                opened = false;
+            } else {
+                text = std::string_view(static_cast<const char *>(mapping), info.st_size);
+            }
+        }
+    }
+    close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return;
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    text = buffer;
+    opened = true;
+#endif
+}
+
+/**
+ * Unmaps the file.
+*/
+inline MappedFile::~MappedFile() {
+#ifdef __unix__
+    if (mapping != nullptr)
+        munmap(mapping, text.size());
+#endif
+}
+
+inline bool MappedFile::isOpen() const {
+    return opened;
+}
+
+/**
+ * Contents of the file, valid while the object exists.
+*/
+inline std::string_view MappedFile::getText() const {
+    return text;
+}
+
+/**
+ * Splits the text of a CSV file in lines and fields without copying it.
+ * A UTF-8 byte order mark at the start is skipped, lines may end in "\n", "\r\n" or "\r"
+ * and empty lines are ignored. Fields are separated by commas and are not quoted.
+*/
+class CsvReader {
+public:
+    CsvReader(std::string_view text);
+
+    bool nextLine();
+    std::string_view nextField();
+
+    static int toInt(std::string_view field);
+    static Capacity toCapacity(std::string_view field);
+
+private:
+    std::string_view text;
+    std::string_view line;
+};
+
+inline CsvReader::CsvReader(std::string_view text) : text(text) {
+    if (this->text.substr(0, 3) == "\xEF\xBB\xBF")
+        this->text.remove_prefix(3);
+}
+
+/**
+ * Moves to the next non empty line.
+ * @return If there was one
+*/
+inline bool CsvReader::nextLine() {
+    while (!text.empty()) {
+        size_t end = text.find_first_of("\r\n");
+        if (end == std::string_view::npos)
+            end = text.size();
+        line = text.substr(0, end);
+        text.remove_prefix(end);
+        if (text.substr(0, 2) == "\r\n")
+            text.remove_prefix(2);
+        else if (!text.empty())
+            text.remove_prefix(1);
+        if (!line.empty())
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Takes the next field of the current line, empty when there are no fields left.
+*/
+inline std::string_view CsvReader::nextField() {
+    size_t end = line.find(',');
+    std::string_view field = line.substr(0, end);
+    line.remove_prefix(end == std::string_view::npos ? line.size() : end + 1);
+    return field;
+}
+
+/**
+ * Integer at the start of a field, ignoring any decimal part. 0 if there is none.
+*/
+inline int CsvReader::toInt(std::string_view field) {
+    int value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    return value;
+}
+
+/**
+ * Capacity, demand or delivery at the start of a field, 0 if there is none.
+ * The decimal part is ignored unless capacities are fractional (see Capacity).
+*/
+inline Capacity CsvReader::toCapacity(std::string_view field) {
+    Capacity value = 0;
+    std::from_chars(field.data(), field.data() + field.size(), value);
+    return value;
+}
+
+#endif //FIRST_PROJECT_DA_MAPPEDFILE_H
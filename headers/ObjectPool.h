@@ -0,0 +1,146 @@
+#ifndef FIRST_PROJECT_DA_OBJECTPOOL_H
+#define FIRST_PROJECT_DA_OBJECTPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Pool of objects of one type, stored next to each other in blocks.
+ * Objects may be destroyed one by one, their place being reused by the next ones,
+ * but they are usually all destroyed at once with the pool.
+ * Each block is twice the size of the previous one, up to maxBlockSize objects,
+ * unless reserve asked for a bigger one.
+*/
+template <typename T>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ~ObjectPool();
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    template <typename... Args>
+    T *create(Args &&...args);
+    void destroy(T *object);
+    void reserve(size_t count);
+    void clear();
+    size_t size() const;
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        Slot *nextFree;
+        bool live;
+    };
+
+    struct Block {
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity;
+    };
+
+    static constexpr size_t minBlockSize = 64;
+    static constexpr size_t maxBlockSize = 4096;
+
+    std::vector<Block> blocks;
+    size_t usedInLast = 0; // Slots of the last block given at least once
+    Slot *freeSlots = nullptr;
+    size_t live = 0;
+
+    void addBlock(size_t capacity);
+};
+
+template <typename T>
+inline ObjectPool<T>::~ObjectPool() {
+    clear();
+}
+
+/**
+ * Builds an object in the pool, in the place of a destroyed one if there is any.
+ * @note Complexity: O(1) amortized
+*/
+template <typename T>
+template <typename... Args>
+inline T *ObjectPool<T>::create(Args &&...args) {
+    Slot *slot = freeSlots;
+    if (slot != nullptr) {
+        freeSlots = slot->nextFree;
+    } else {
+        if (blocks.empty() || usedInLast == blocks.back().capacity)
+            addBlock(blocks.empty() ? minBlockSize : std::min(blocks.back().capacity * 2, maxBlockSize));
+        slot = &blocks.back().slots[usedInLast++];
+    }
+    T *object = new (slot->storage) T(std::forward<Args>(args)...);
+    slot->live = true;
+    live++;
+    return object;
+}
+
+/**
+ * Destroys an object of the pool, whose place is given to the next one created.
+ * @note Complexity: O(1)
+*/
+template <typename T>
+inline void ObjectPool<T>::destroy(T *object) {
+    object->~T();
+    Slot *slot = reinterpret_cast<Slot *>(reinterpret_cast<unsigned char *>(object) - offsetof(Slot, storage));
+    slot->live = false;
+    slot->nextFree = freeSlots;
+    freeSlots = slot;
+    live--;
+}
+
+/**
+ * Makes room for a number of objects in a single block, so creating them allocates nothing.
+ * @note Complexity: O(1)
+*/
+template <typename T>
+inline void ObjectPool<T>::reserve(size_t count) {
+    size_t available = blocks.empty() ? 0 : blocks.back().capacity - usedInLast;
+    if (count > available)
+        addBlock(count);
+}
+
+/**
+ * Destroys every object and frees the blocks.
+ * @note Complexity: O(n) where n is the number of places given
+*/
+template <typename T>
+inline void ObjectPool<T>::clear() {
+    for (size_t b = 0; b < blocks.size(); b++) {
+        size_t used = b + 1 == blocks.size() ? usedInLast : blocks[b].capacity;
+        for (size_t i = 0; i < used; i++) {
+            Slot &slot = blocks[b].slots[i];
+            if (slot.live)
+                reinterpret_cast<T *>(slot.storage)->~T();
+        }
+    }
+    blocks.clear();
+    usedInLast = 0;
+    freeSlots = nullptr;
+    live = 0;
+}
+
+/**
+ * Number of objects alive in the pool.
+*/
+template <typename T>
+inline size_t ObjectPool<T>::size() const {
+    return live;
+}
+
+/**
+ * Starts a new block, the slots left in the previous one being lost until the pool is cleared.
+*/
+template <typename T>
+inline void ObjectPool<T>::addBlock(size_t capacity) {
+    blocks.push_back({std::unique_ptr<Slot[]>(new Slot[capacity]), capacity});
+    for (size_t i = 0; i < capacity; i++)
+        blocks.back().slots[i].live = false;
+    usedInLast = 0;
+}
+
+#endif //FIRST_PROJECT_DA_OBJECTPOOL_H
@@ -2,6 +2,7 @@
 #define FIRST_PROJECT_DA_RESERVOIR_H
 
 #include <string>
+#include "Capacity.h"
 #include "Element.h"
 
 /**
@@ -12,19 +13,20 @@ class Reservoir : public Element {
     private:
         std::string name;
         std::string municipality;
-        int maxDelivery = 0;
+        Capacity maxDelivery = 0;
     public:
-        Reservoir(int id, std::string code, std::string name, std::string municipality, int maxDelivery);
+        Reservoir(int id, std::string code, std::string name, std::string municipality, Capacity maxDelivery);
         std::string getName() const;
         std::string getMunicipality() const;
-        int getMaxDelivery() const;
+        Capacity getMaxDelivery() const;
+        void setMaxDelivery(Capacity maxDelivery);
 };
 
 /**
  * Constructor, fills all varibles within the class.
 */
-inline Reservoir::Reservoir(int id, std::string code, std::string name, std::string municipality, int maxDelivery)
-    : Element(id, code), name(name), municipality(municipality), maxDelivery(maxDelivery) {}
+inline Reservoir::Reservoir(int id, std::string code, std::string name, std::string municipality, Capacity maxDelivery)
+    : Element(id, code, ElementType::Reservoir), name(name), municipality(municipality), maxDelivery(maxDelivery) {}
 
 /**
  * Getter for name
@@ -43,8 +45,15 @@ inline std::string Reservoir::getMunicipality() const {
 /**
  * Getter for the maximum delivery of water supported by the reservoir.
 */
-inline int Reservoir::getMaxDelivery() const {
+inline Capacity Reservoir::getMaxDelivery() const {
     return maxDelivery;
 }
 
+/**
+ * Setter for the maximum delivery of water supported by the reservoir.
+*/
+inline void Reservoir::setMaxDelivery(Capacity maxDelivery) {
+    this->maxDelivery = maxDelivery;
+}
+
 #endif //FIRST_PROJECT_DA_RESERVOIR_H
@@ -0,0 +1,71 @@
+#ifndef FIRST_PROJECT_DA_SPAN_H
+#define FIRST_PROJECT_DA_SPAN_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Read-only view of items stored next to each other, such as the contents of a vector.
+ * It does not own the items: it stays valid until the vector it was taken from changes,
+ * so a list that is changed while it is read must be copied first (see toVector).
+*/
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(const T *first, size_t count);
+    Span(const std::vector<T> &items);
+
+    const T *begin() const;
+    const T *end() const;
+    size_t size() const;
+    bool empty() const;
+    const T &operator[](size_t i) const;
+    std::vector<T> toVector() const;
+
+private:
+    const T *first = nullptr;
+    size_t count = 0;
+};
+
+template <typename T>
+inline Span<T>::Span(const T *first, size_t count) : first(first), count(count) {}
+
+template <typename T>
+inline Span<T>::Span(const std::vector<T> &items) : first(items.data()), count(items.size()) {}
+
+template <typename T>
+inline const T *Span<T>::begin() const {
+    return first;
+}
+
+template <typename T>
+inline const T *Span<T>::end() const {
+    return first + count;
+}
+
+template <typename T>
+inline size_t Span<T>::size() const {
+    return count;
+}
+
+template <typename T>
+inline bool Span<T>::empty() const {
+    return count == 0;
+}
+
+template <typename T>
+inline const T &Span<T>::operator[](size_t i) const {
+    return first[i];
+}
+
+/**
+ * Copy of the items, for when the list viewed may change while it is read.
+ * @note Complexity: O(n)
+*/
+template <typename T>
+inline std::vector<T> Span<T>::toVector() const {
+    return std::vector<T>(begin(), end());
+}
+
+#endif //FIRST_PROJECT_DA_SPAN_H
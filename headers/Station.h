@@ -13,7 +13,7 @@ class Station : public Element {
 		 * Only available constructor. 
 		 * Fills all the required information of the parent class.
 		*/
-        Station(int id, std::string code) : Element(id, code) {};
+        Station(int id, std::string code) : Element(id, code, ElementType::Station) {};
 };
 
 #endif //FIRST_PROJECT_DA_STATION_H
@@ -0,0 +1,171 @@
+#ifndef FIRST_PROJECT_DA_STATS_H
+#define FIRST_PROJECT_DA_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+/**
+ * Statistics of the solvers are compiled in unless DA_STATS is defined as 0,
+ * and only collected while switched on at runtime (Stats::setEnabled).
+*/
+#ifndef DA_STATS
+#define DA_STATS 1
+#endif
+
+/**
+ * Events counted by the statistics.
+*/
+enum class Counter {
+    AugmentingPaths,  // Paths augmented by Edmonds-Karp, Dinic and the balancing search, push-relabel adding none
+    SearchPasses,     // Breadth-first searches: for a path, the levels of Dinic or the labels of push-relabel
+    EdgesScanned,     // Arcs looked at by every solver
+    VerticesReset,    // Vertices whose search state was cleared before a search
+    VertexLookups,    // Vertices searched by element or code
+    BytesAllocated,   // Vertices and edges of graphs
+    RowsLoaded,       // Lines read from the CSV files
+    Count
+};
+
+/**
+ * Functions whose time is measured by the statistics.
+*/
+enum class Timer {
+    EdmondsKarp,
+    FarthestAugmentingPath,
+    LoadReservoirs,
+    LoadStations,
+    LoadCities,
+    LoadPipes,
+    Count
+};
+
+/**
+ * Counters and timers shared by every thread.
+ * Hot loops count in local variables and add the total once, so the cost while switched on
+ * is a few atomic additions per call, and a single flag check while switched off.
+ * Timers add the time of every call, in every thread.
+*/
+class Stats {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    static void add(Counter counter, uint64_t amount);
+    static void addTime(Timer timer, uint64_t nanoseconds);
+    static uint64_t get(Counter counter);
+    static void reset();
+    static void print(std::ostream &out);
+
+private:
+    static const char *const COUNTER_NAMES[(int)Counter::Count];
+    static const char *const TIMER_NAMES[(int)Timer::Count];
+
+    static inline std::atomic<bool> enabled{false};
+    static inline std::atomic<uint64_t> counters[(int)Counter::Count] = {};
+    static inline std::atomic<uint64_t> timerCalls[(int)Timer::Count] = {};
+    static inline std::atomic<uint64_t> timerNanoseconds[(int)Timer::Count] = {};
+};
+
+inline const char *const Stats::COUNTER_NAMES[(int)Counter::Count] = {
+    "Augmenting paths", "Search passes", "Edges scanned", "Vertices reset", "Vertex lookups",
+    "Bytes allocated", "Rows loaded"
+};
+
+inline const char *const Stats::TIMER_NAMES[(int)Timer::Count] = {
+    "EdmondsKarp", "FarthestAugmentingPath", "loadReservoirs", "loadStations", "loadCities", "loadPipes"
+};
+
+inline void Stats::setEnabled(bool enabled) {
+    Stats::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+inline bool Stats::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+inline void Stats::add(Counter counter, uint64_t amount) {
+    counters[(int)counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline void Stats::addTime(Timer timer, uint64_t nanoseconds) {
+    timerCalls[(int)timer].fetch_add(1, std::memory_order_relaxed);
+    timerNanoseconds[(int)timer].fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+inline uint64_t Stats::get(Counter counter) {
+    return counters[(int)counter].load(std::memory_order_relaxed);
+}
+
+/**
+ * Sets every counter and timer back to 0.
+*/
+inline void Stats::reset() {
+    for (auto &counter : counters)
+        counter.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < (int)Timer::Count; i++) {
+        timerCalls[i].store(0, std::memory_order_relaxed);
+        timerNanoseconds[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Writes a table with every counter and timer.
+*/
+inline void Stats::print(std::ostream &out) {
+    if (!DA_STATS) {
+        out << "Statistics were not compiled in (DA_STATS=0)\n";
+        return;
+    }
+    out << "Statistics (" << (isEnabled() ? "collecting" : "not collecting") << ")\n\n"
+        << std::left << std::setw(26) << "Counter" << std::right << std::setw(16) << "value" << "\n";
+    for (int i = 0; i < (int)Counter::Count; i++)
+        out << std::left << std::setw(26) << COUNTER_NAMES[i] << std::right << std::setw(16) << counters[i].load() << "\n";
+
+    out << "\n" << std::left << std::setw(26) << "Timer" << std::right << std::setw(16) << "calls"
+        << std::setw(16) << "total ms" << "\n";
+    for (int i = 0; i < (int)Timer::Count; i++) {
+        out << std::left << std::setw(26) << TIMER_NAMES[i] << std::right << std::setw(16) << timerCalls[i].load()
+            << std::setw(16) << std::fixed << std::setprecision(3) << timerNanoseconds[i].load() / 1e6 << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+/**
+ * Adds the time from its creation to its destruction to a timer, if the statistics are switched on.
+*/
+class ScopedTimer {
+public:
+    ScopedTimer(Timer timer);
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Timer timer;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline ScopedTimer::ScopedTimer(Timer timer) : timer(timer), running(Stats::isEnabled()) {
+    if (running)
+        start = std::chrono::steady_clock::now();
+}
+
+inline ScopedTimer::~ScopedTimer() {
+    if (running) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        Stats::addTime(timer, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+}
+
+#if DA_STATS
+#define STATS_ADD(counter, amount) do { if (Stats::isEnabled()) Stats::add(Counter::counter, (amount)); } while (0)
+#define STATS_TIMER(timer) ScopedTimer statsTimer(Timer::timer)
+#else
+#define STATS_ADD(counter, amount) do { } while (0)
+#define STATS_TIMER(timer) do { } while (0)
+#endif
+
+#endif //FIRST_PROJECT_DA_STATS_H
@@ -0,0 +1,120 @@
+#ifndef FIRST_PROJECT_DA_THREADPOOL_H
+#define FIRST_PROJECT_DA_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Trace.h"
+
+/**
+ * Fixed set of threads used to run independent tasks.
+ * A job runs a function for every index in [0, count), the indices being handed out
+ * through an atomic counter. The function also gets the number of the worker running it,
+ * so each worker can keep a workspace of its own.
+*/
+class ThreadPool {
+public:
+    typedef std::function<void(size_t index, unsigned worker)> Task;
+
+    ThreadPool(unsigned threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const;
+    void run(size_t count, const Task &task);
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const Task *task = nullptr;
+    size_t count = 0;
+    std::atomic<size_t> next{0};
+    unsigned running = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    void work(unsigned worker);
+};
+
+/**
+ * Starts the threads, at least one.
+*/
+inline ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0)
+        threads = 1;
+    for (unsigned i = 0; i < threads; i++)
+        workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+/**
+ * Waits for the threads to finish.
+*/
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &thread : workers)
+        thread.join();
+}
+
+/**
+ * Number of threads in the pool.
+*/
+inline unsigned ThreadPool::size() const {
+    return workers.size();
+}
+
+/**
+ * Runs a task for every index in [0, count) and waits until all of them are done.
+ * The order in which indices are run is not defined.
+ * @note Complexity: O(count / threads) tasks per thread
+*/
+inline void ThreadPool::run(size_t count, const Task &task) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->task = &task;
+    this->count = count;
+    next = 0;
+    running = workers.size();
+    generation++;
+    wake.notify_all();
+    done.wait(lock, [this]{ return running == 0; });
+    this->task = nullptr;
+}
+
+/**
+ * Loop of each thread, waiting for a job and taking indices until there are none left.
+*/
+inline void ThreadPool::work(unsigned worker) {
+    Trace::nameThread("worker " + std::to_string(worker));
+    unsigned seen = 0;
+    while (true) {
+        const Task *current;
+        size_t total;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen]{ return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            current = task;
+            total = count;
+        }
+        for (size_t i = next++; i < total; i = next++)
+            (*current)(i, worker);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0)
+                done.notify_one();
+        }
+    }
+}
+
+#endif //FIRST_PROJECT_DA_THREADPOOL_H
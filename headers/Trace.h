@@ -0,0 +1,157 @@
+#ifndef FIRST_PROJECT_DA_TRACE_H
+#define FIRST_PROJECT_DA_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+/**
+ * Timeline of the work done by the program, written as trace events in the Chrome JSON format
+ * (open it in chrome://tracing or ui.perfetto.dev).
+ * Each span is written as soon as it ends, and the file is closed when the program exits,
+ * so a trace is kept whichever menu the program is left from.
+ * Threads are numbered in the order they first record a span, the one calling start being 1.
+*/
+class Trace {
+public:
+    static bool start(const std::string &path);
+    static void stop();
+    static bool isEnabled();
+    static void nameThread(const std::string &name);
+    static void record(std::string_view name, const char *category,
+                       std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end);
+
+private:
+    static inline std::atomic<bool> enabled{false};
+    static inline std::mutex mutex;
+    static inline std::ofstream out;
+    static inline std::chrono::steady_clock::time_point origin;
+    static inline std::atomic<int> numThreads{0};
+
+    static int threadId();
+    static void writeEscaped(std::string_view text);
+    static double microseconds(std::chrono::steady_clock::time_point time);
+};
+
+/**
+ * Starts writing the trace to a file, replacing it.
+ * @return If the file could be opened
+*/
+inline bool Trace::start(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (out.is_open())
+        return true;
+    out.open(path, std::ofstream::trunc);
+    if (!out)
+        return false;
+    origin = std::chrono::steady_clock::now();
+    threadId();
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"first_project_DA\"}}";
+    enabled = true;
+    std::atexit(stop);
+    return true;
+}
+
+/**
+ * Stops the trace and closes its file. Spans ending afterwards are dropped.
+*/
+inline void Trace::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    enabled = false;
+    if (out.is_open()) {
+        out << "\n]}\n";
+        out.close();
+    }
+}
+
+inline bool Trace::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Number of the calling thread in the trace, given the first time it is asked for.
+*/
+inline int Trace::threadId() {
+    thread_local int id = ++numThreads;
+    return id;
+}
+
+/**
+ * Name shown for the calling thread in the timeline.
+*/
+inline void Trace::nameThread(const std::string &name) {
+    if (!isEnabled())
+        return;
+    int id = threadId();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out.is_open())
+        return;
+    out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << id << ",\"args\":{\"name\":\"";
+    writeEscaped(name);
+    out << "\"}}";
+}
+
+/**
+ * Writes a span that ran from begin to end in the calling thread.
+*/
+inline void Trace::record(std::string_view name, const char *category,
+                          std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end) {
+    int id = threadId();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out.is_open())
+        return;
+    out << ",\n{\"name\":\"";
+    writeEscaped(name);
+    out << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"ts\":" << microseconds(begin)
+        << ",\"dur\":" << microseconds(end) - microseconds(begin) << ",\"pid\":1,\"tid\":" << id << "}";
+}
+
+inline void Trace::writeEscaped(std::string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        if ((unsigned char)c >= 0x20)
+            out << c;
+    }
+}
+
+inline double Trace::microseconds(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration<double, std::micro>(time - origin).count();
+}
+
+/**
+ * Span of the trace, from its creation to its destruction.
+ * Costs a single flag check while the trace is off.
+*/
+class TraceSpan {
+public:
+    TraceSpan(std::string_view name, const char *category);
+    ~TraceSpan();
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    std::string name;
+    const char *category;
+    bool running;
+    std::chrono::steady_clock::time_point begin;
+};
+
+inline TraceSpan::TraceSpan(std::string_view name, const char *category) : category(category), running(Trace::isEnabled()) {
+    if (running) {
+        this->name = name;
+        begin = std::chrono::steady_clock::now();
+    }
+}
+
+inline TraceSpan::~TraceSpan() {
+    if (running)
+        Trace::record(name, category, begin, std::chrono::steady_clock::now());
+}
+
+#endif //FIRST_PROJECT_DA_TRACE_H
@@ -3,6 +3,7 @@
 
 #include "Manager.h"
 #include <chrono>
+#include <future>
 
 #ifdef __linux__
 # define CLEAR (void)system("clear")
@@ -10,16 +11,47 @@
 # define CLEAR (void)system("cls")
 #endif
 
+/**
+ * Options chosen in the command line.
+*/
+struct Options {
+	bool useSmallSet = false;
+	std::string dataset;
+	FlowAlgorithm algorithm = FlowAlgorithm::EdmondsKarp;
+	int parallelThreshold = 100000;
+	unsigned threads = 0;
+	std::string snapshot;
+	std::string convert;
+	bool useCache = true;
+	bool lazy = false;
+	size_t memoCapacity = 1024;
+	bool stats = false;
+	std::string trace;
+};
+
+/**
+ * Stages of the startup, in the order they run.
+ * Everything after LOAD runs in the background while the main menu is shown.
+*/
+enum Stage { LOAD, MAX_FLOW, DEFICIT, RELIABILITY, STAGES };
+
 /**
  * Class containing the methods used for displaying the UI.
  * The Ui itself accessed a Manager to get what information to display
 */
 class UI {
 	private:
-		long loadtime;
+		double stageTime[STAGES] = {};
+		std::shared_future<void> stageDone[STAGES];
 		Manager manager;
+		std::future<void> pipeline; // Destroyed before the manager, waiting for the background stages
+
+		void startPipeline(const Options &options, bool calculateMaxFlow);
+		bool isDone(Stage stage) const;
+		void waitFor(Stage stage);
+		void quit();
 	public:
-		UI(bool useSmallSet);
+		UI(const Options &options);
 
 		void mainMenu();
 
@@ -33,8 +65,12 @@ class UI {
 		void removePSMenu();
 		void removePipeMenu();
 
+		// Updates
+		void updateNetworkMenu();
+
 		// Utils
 		void testMenu();
+		void statsMenu();
 		static bool strFind(const std::string &one, const std::string &two);
 		void helpMsg(std::string error, std::string usage);
 };
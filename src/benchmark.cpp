@@ -0,0 +1,512 @@
+#include "../headers/Generator.h"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <thread>
+
+/**
+ * Benchmark suite of the manager.
+ * Compares the max flow algorithms on the bundled datasets and on random networks of increasing size,
+ * times the operations of the menus (max flow, reservoir removal, pipe and pumping station
+ * maintenance, balancing) and the CSV loaders, then the scaling of the parallel push-relabel
+ * algorithm with the number of threads and the startup time from the CSV files and from a binary snapshot.
+ * Random networks always use the same seed, so every run measures the same work.
+ * Besides the tables, every measure can be saved as JSON or CSV to track regressions.
+ * Like the main program, it must be executed from the build folder.
+*/
+
+/**
+ * Times of the runs of a benchmark, in milliseconds.
+*/
+struct Timing {
+	int runs = 0;
+	double mean = 0;
+	double min = 0;
+	double max = 0;
+	double stddev = 0;
+};
+
+/**
+ * One measure of the suite.
+ * @param value Result of the measured operation (flow, number of affected cities, ...), to spot wrong results
+*/
+struct BenchResult {
+	std::string suite;
+	std::string network;
+	std::string benchmark;
+	std::string variant;
+	Timing time;
+	double value;
+};
+
+static std::vector<BenchResult> results;
+
+void record(const std::string &suite, const std::string &network, const std::string &benchmark,
+			const std::string &variant, const Timing &time, double value)
+{
+	results.push_back({suite, network, benchmark, variant, time, value});
+}
+
+/**
+ * Fills an empty manager with a random network (see NetworkGenerator),
+ * 30% of the pipes between stations being bidirectional.
+ * @note Complexity: O(E log E + V)
+*/
+void buildSynthetic(Manager &manager, int numReservoirs, int numStations, int numCities, int numPipes, unsigned seed)
+{
+	GeneratorOptions options;
+	options.reservoirs = numReservoirs;
+	options.stations = numStations;
+	options.cities = numCities;
+	options.pipes = numPipes;
+	options.seed = seed;
+	NetworkGenerator(options).fill(manager);
+}
+
+/**
+ * Runs a function several times, timing each run on its own.
+ * @param setup Called before each run, outside of the time
+ * @return Times of the runs
+*/
+Timing measure(int repeat, const std::function<void()> &run, const std::function<void()> &setup = nullptr)
+{
+	std::vector<double> times;
+	for (int i = 0; i < repeat; i++)
+	{
+		if (setup)
+			setup();
+		auto start = std::chrono::steady_clock::now();
+		run();
+		auto end = std::chrono::steady_clock::now();
+		times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+
+	Timing timing;
+	timing.runs = times.size();
+	timing.min = *std::min_element(times.begin(), times.end());
+	timing.max = *std::max_element(times.begin(), times.end());
+	for (double time : times)
+		timing.mean += time / times.size();
+	for (double time : times)
+		timing.stddev += (time - timing.mean) * (time - timing.mean) / times.size();
+	timing.stddev = std::sqrt(timing.stddev);
+	return timing;
+}
+
+/**
+ * Loads a bundled dataset from the CSV files.
+*/
+void loadDataset(Manager &manager)
+{
+	manager.loadCities();
+	manager.loadReservoirs();
+	manager.loadStations();
+	manager.loadPipes();
+}
+
+/**
+ * Number of pumping stations whose failure affects some city.
+*/
+size_t affectedStations(const Manager &manager)
+{
+	return std::count_if(manager.rmPS.begin(), manager.rmPS.end(), [](const FlowComb &cities) { return !cities.empty(); });
+}
+
+/**
+ * Times the max flow of a network with every algorithm and prints a line of the results table.
+*/
+void compare(Manager &manager, const std::string &name, int repeat, bool withReliability)
+{
+	const std::pair<FlowAlgorithm, std::string> algorithms[] = {
+		{FlowAlgorithm::EdmondsKarp, "edmonds-karp"},
+		{FlowAlgorithm::Dinic, "dinic"},
+		{FlowAlgorithm::PushRelabel, "push-relabel"},
+		{FlowAlgorithm::ParallelPushRelabel, "parallel-pr"}
+	};
+
+	double expected = -1;
+	for (const auto &[algorithm, algorithmName] : algorithms)
+	{
+		manager.algorithm = algorithm;
+		manager.parallelThreshold = 0;
+		double total = 0;
+		Timing timing = measure(repeat, [&]() { total = manager.CalculateMaxFlow(manager.network); });
+		double maxFlow = timing.mean;
+		record("maxflow", name, "CalculateMaxFlow", algorithmName, timing, total);
+
+		std::cout << std::left << std::setw(28) << name << std::setw(14) << algorithmName
+				  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << maxFlow;
+		if (withReliability)
+		{
+			manager.maxFlowCities();
+			manager.rmPipelines.clear();
+			manager.rmPS.clear();
+			Timing reliabilityTiming = measure(1, [&]() { manager.maintenancePipes(); manager.maintenancePS(); });
+			double reliability = reliabilityTiming.mean;
+			record("maxflow", name, "maintenancePipes+maintenancePS", algorithmName, reliabilityTiming,
+				   manager.rmPipelines.size() + affectedStations(manager));
+			std::cout << std::setw(16) << reliability;
+		}
+		else
+			std::cout << std::setw(16) << "-";
+		std::cout << std::setw(12) << std::setprecision(0) << total
+				  << (expected >= 0 && expected != total ? "  MISMATCH" : "") << std::endl;
+		if (expected < 0)
+			expected = total;
+	}
+}
+
+/**
+ * Times the operations behind the menus on a network with the default algorithm, each on the
+ * max flow of the network, and prints a line of the operations table per operation.
+ * @param withReliability If the pipe and pumping station maintenance are timed, slow on big networks
+*/
+void operations(Manager &manager, const std::string &name, int repeat, bool withReliability)
+{
+	manager.algorithm = FlowAlgorithm::EdmondsKarp;
+	manager.parallelThreshold = 100000;
+	manager.maxFlowCities();
+
+	auto print = [&](const std::string &benchmark, const Timing &timing, double value) {
+		record("operations", name, benchmark, "edmonds-karp", timing, value);
+		std::cout << std::left << std::setw(28) << name << std::setw(22) << benchmark << std::right
+				  << std::setw(12) << std::fixed << std::setprecision(3) << timing.mean
+				  << std::setw(12) << timing.min << std::setw(12) << timing.stddev
+				  << std::setw(10) << std::setprecision(0) << value << std::endl;
+	};
+
+	double total = 0;
+	Timing timing = measure(repeat, [&]() { total = manager.CalculateMaxFlow(manager.network); });
+	print("CalculateMaxFlow", timing, total);
+
+	// Every reservoir once per run
+	size_t affected = 0;
+	timing = measure(repeat, [&]() {
+		affected = 0;
+		for (const auto &[code, reservoir] : manager.reservoirs)
+			affected += manager.removeReservoir(reservoir).size();
+	});
+	print("removeReservoir", timing, affected);
+
+	if (withReliability)
+	{
+		auto reset = [&]() {
+			manager.maxFlowCities();
+			manager.rmPipelines.clear();
+			manager.rmPS.clear();
+		};
+		timing = measure(repeat, [&]() { manager.maintenancePipes(); }, reset);
+		print("maintenancePipes", timing, manager.rmPipelines.size());
+		timing = measure(repeat, [&]() { manager.maintenancePS(); }, reset);
+		print("maintenancePS", timing, affectedStations(manager));
+	}
+
+	double variance = 0;
+	timing = measure(repeat, [&]() { variance = std::get<1>(manager.balanceNetwork().second); });
+	print("balanceNetwork", timing, variance);
+}
+
+/**
+ * Times each CSV loader on the bundled datasets, every run loading into a new manager.
+ * A loader only runs after the ones it depends on, which are not timed.
+*/
+void loaders(int repeat)
+{
+	const std::pair<std::string, void (Manager::*)()> steps[] = {
+		{"loadCities", &Manager::loadCities},
+		{"loadReservoirs", &Manager::loadReservoirs},
+		{"loadStations", &Manager::loadStations},
+		{"loadPipes", &Manager::loadPipes}
+	};
+
+	std::cout << "\nLoaders\n"
+			  << std::left << std::setw(28) << "network" << std::setw(22) << "loader" << std::right
+			  << std::setw(12) << "mean ms" << std::setw(12) << "min ms" << std::setw(12) << "stddev" << "\n";
+
+	for (bool small : {true, false})
+	{
+		std::string network = small ? "dataset/small" : "dataset";
+		for (size_t step = 0; step < std::size(steps); step++)
+		{
+			Manager *manager = nullptr;
+			Timing timing = measure(repeat, [&]() { (manager->*steps[step].second)(); }, [&]() {
+				delete manager;
+				manager = new Manager(small);
+				for (size_t before = 0; before < step; before++)
+					(manager->*steps[before].second)();
+			});
+			double elements = manager->network.getNumVertex();
+			delete manager;
+
+			record("loaders", network, steps[step].first, "", timing, elements);
+			std::cout << std::left << std::setw(28) << network << std::setw(22) << steps[step].first << std::right
+					  << std::setw(12) << std::fixed << std::setprecision(3) << timing.mean
+					  << std::setw(12) << timing.min << std::setw(12) << timing.stddev << std::endl;
+		}
+	}
+}
+
+/**
+ * Times the parallel push-relabel algorithm with 1 to maxThreads threads (doubling each time)
+ * on a random network with one million pipes, next to the sequential version.
+*/
+void scaling(unsigned maxThreads)
+{
+	Manager manager(false);
+	buildSynthetic(manager, 5000, 100000, 20000, 1000000, 42);
+	manager.parallelThreshold = 0;
+
+	std::cout << "\nParallel push-relabel, synthetic 1000000 pipes ("
+			  << std::thread::hardware_concurrency() << " hardware threads)\n"
+			  << std::left << std::setw(28) << "threads" << std::right << std::setw(12) << "maxflow ms"
+			  << std::setw(12) << "speedup" << std::setw(12) << "flow" << "\n";
+
+	manager.algorithm = FlowAlgorithm::PushRelabel;
+	double total = 0;
+	manager.CalculateMaxFlow(manager.network); // Builds the residual graph
+	Timing sequentialTiming = measure(1, [&]() { total = manager.CalculateMaxFlow(manager.network); });
+	double sequential = sequentialTiming.mean;
+	record("scaling", "synthetic 1000000 pipes", "CalculateMaxFlow", "push-relabel", sequentialTiming, total);
+	std::cout << std::left << std::setw(28) << "sequential" << std::right << std::setw(12) << std::fixed
+			  << std::setprecision(3) << sequential << std::setw(12) << 1.0
+			  << std::setw(12) << std::setprecision(0) << total << std::endl;
+
+	manager.algorithm = FlowAlgorithm::ParallelPushRelabel;
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		manager.maxThreads = threads;
+		Timing timing = measure(1, [&]() { total = manager.CalculateMaxFlow(manager.network); });
+		double time = timing.mean;
+		record("scaling", "synthetic 1000000 pipes", "CalculateMaxFlow",
+			   "parallel-pr " + std::to_string(threads) + " threads", timing, total);
+		std::cout << std::left << std::setw(28) << threads << std::right << std::setw(12) << std::setprecision(3)
+				  << time << std::setw(12) << sequential / time
+				  << std::setw(12) << std::setprecision(0) << total << std::endl;
+	}
+}
+
+/**
+ * Times loading each bundled dataset and calculating its max flow from the CSV files,
+ * against loading the same network and flow from a binary snapshot.
+*/
+void startup(int repeat)
+{
+	const std::string snapshot = "bench_snapshot.bin";
+
+	std::cout << "\nStartup\n"
+			  << std::left << std::setw(28) << "network" << std::right << std::setw(12) << "csv ms"
+			  << std::setw(14) << "snapshot ms" << std::setw(12) << "speedup" << "\n";
+
+	for (bool small : {true, false})
+	{
+		std::string network = small ? "dataset/small" : "dataset";
+		Timing csvTiming = measure(repeat, [&]() {
+			Manager manager(small);
+			loadDataset(manager);
+			manager.maxFlowCities();
+		});
+		double csv = csvTiming.mean;
+		record("startup", network, "csv+maxFlowCities", "", csvTiming, 0);
+
+		{
+			Manager manager(small);
+			loadDataset(manager);
+			manager.saveSnapshot(snapshot);
+		}
+		Timing binaryTiming = measure(repeat, [&]() {
+			Manager manager(small);
+			manager.loadSnapshot(snapshot);
+		});
+		double binary = binaryTiming.mean;
+		record("startup", network, "loadSnapshot", "", binaryTiming, 0);
+
+		std::cout << std::left << std::setw(28) << network << std::right
+				  << std::setw(12) << std::fixed << std::setprecision(3) << csv << std::setw(14) << binary
+				  << std::setw(12) << csv / binary << std::endl;
+	}
+	std::remove(snapshot.c_str());
+}
+
+/**
+ * Escapes a text as a JSON string.
+*/
+std::string jsonString(const std::string &text)
+{
+	std::string result = "\"";
+	for (char c : text)
+	{
+		if (c == '"' || c == '\\')
+			result += '\\';
+		result += c;
+	}
+	return result + "\"";
+}
+
+/**
+ * Escapes a text as a CSV field.
+*/
+std::string csvField(const std::string &text)
+{
+	if (text.find_first_of(",\"\n") == std::string::npos)
+		return text;
+	std::string result = "\"";
+	for (char c : text)
+	{
+		if (c == '"')
+			result += '"';
+		result += c;
+	}
+	return result + "\"";
+}
+
+/**
+ * Saves every measure as JSON: the settings of the run and a list of results.
+ * Values that are not finite numbers are saved as null.
+ * @return If the file could be written
+*/
+bool writeJson(const std::string &path, int repeat, unsigned maxThreads)
+{
+	std::ofstream out(path, std::ofstream::trunc);
+	out << std::setprecision(6) << "{\n"
+		<< "  \"repetitions\": " << repeat << ",\n"
+		<< "  \"max_threads\": " << maxThreads << ",\n"
+		<< "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "  \"results\": [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult &r = results[i];
+		out << (i == 0 ? "\n" : ",\n")
+			<< "    {\"suite\": " << jsonString(r.suite) << ", \"network\": " << jsonString(r.network)
+			<< ", \"benchmark\": " << jsonString(r.benchmark) << ", \"variant\": " << jsonString(r.variant)
+			<< ", \"runs\": " << r.time.runs << ", \"mean_ms\": " << r.time.mean << ", \"min_ms\": " << r.time.min
+			<< ", \"max_ms\": " << r.time.max << ", \"stddev_ms\": " << r.time.stddev << ", \"value\": ";
+		if (std::isfinite(r.value))
+			out << std::setprecision(15) << r.value << std::setprecision(6);
+		else
+			out << "null";
+		out << "}";
+	}
+	out << "\n  ]\n}\n";
+	return out.good();
+}
+
+/**
+ * Saves every measure as CSV, one line per result.
+ * Values that are not finite numbers are left empty.
+ * @return If the file could be written
+*/
+bool writeCsv(const std::string &path)
+{
+	std::ofstream out(path, std::ofstream::trunc);
+	out << "suite,network,benchmark,variant,runs,mean_ms,min_ms,max_ms,stddev_ms,value\n" << std::setprecision(6);
+	for (const BenchResult &r : results)
+	{
+		out << csvField(r.suite) << ',' << csvField(r.network) << ',' << csvField(r.benchmark) << ','
+			<< csvField(r.variant) << ',' << r.time.runs << ',' << r.time.mean << ',' << r.time.min << ','
+			<< r.time.max << ',' << r.time.stddev << ',';
+		if (std::isfinite(r.value))
+			out << std::setprecision(15) << r.value << std::setprecision(6);
+		out << '\n';
+	}
+	return out.good();
+}
+
+/**
+ * Usage: first_project_DA_bench [repetitions] [max threads] [--quick] [--json=FILE] [--csv=FILE] [--stats]
+ *  --quick  Skips the largest random networks (100000 pipes and more)
+ *  --json=FILE, --csv=FILE  Also save every measure to a file
+ *  --stats  Collects the statistics of the solvers over the whole run and prints them at the end,
+ *           the timings including their overhead
+*/
+int main(int argc, char **argv)
+{
+	int repeat = 5;
+	unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	bool quick = false;
+	std::string jsonPath, csvPath;
+	int positional = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--quick")
+			quick = true;
+		else if (arg.substr(0, 7) == "--json=")
+			jsonPath = arg.substr(7);
+		else if (arg.substr(0, 6) == "--csv=")
+			csvPath = arg.substr(6);
+		else if (arg == "--stats")
+			Stats::setEnabled(true);
+		else if (arg.substr(0, 2) != "--" && positional < 2)
+		{
+			if (positional++ == 0)
+				repeat = std::max(1, atoi(arg.c_str()));
+			else
+				maxThreads = std::max(1, atoi(arg.c_str()));
+		}
+		else
+		{
+			std::cout << "Usage: " << argv[0] << " [repetitions] [max threads] [--quick] [--json=FILE] [--csv=FILE] [--stats]\n";
+			return 1;
+		}
+	}
+
+	std::cout << std::left << std::setw(28) << "network" << std::setw(14) << "algorithm"
+			  << std::right << std::setw(12) << "maxflow ms" << std::setw(16) << "reliability ms"
+			  << std::setw(12) << "flow" << "\n";
+
+	for (bool small : {true, false})
+	{
+		Manager manager(small);
+		loadDataset(manager);
+		compare(manager, small ? "dataset/small" : "dataset", repeat, true);
+	}
+
+	for (int scale : {1, 10, 100})
+	{
+		if (quick && scale >= 100)
+			continue;
+		int stations = 100 * scale;
+		int pipes = 1000 * scale;
+		Manager manager(false);
+		buildSynthetic(manager, 5 * scale, stations, 20 * scale, pipes, 42);
+		compare(manager, "synthetic " + std::to_string(pipes) + " pipes", scale >= 100 ? 1 : repeat, scale == 1);
+	}
+
+	std::cout << "\nOperations (edmonds-karp)\n"
+			  << std::left << std::setw(28) << "network" << std::setw(22) << "operation" << std::right
+			  << std::setw(12) << "mean ms" << std::setw(12) << "min ms" << std::setw(12) << "stddev"
+			  << std::setw(10) << "result" << "\n";
+	for (bool small : {true, false})
+	{
+		Manager manager(small);
+		loadDataset(manager);
+		operations(manager, small ? "dataset/small" : "dataset", repeat, true);
+	}
+	for (int scale : {1, 10})
+	{
+		Manager manager(false);
+		buildSynthetic(manager, 5 * scale, 100 * scale, 20 * scale, 1000 * scale, 42);
+		operations(manager, "synthetic " + std::to_string(1000 * scale) + " pipes", scale == 1 ? repeat : 1, scale == 1);
+	}
+
+	loaders(repeat);
+	if (!quick)
+		scaling(maxThreads);
+	startup(repeat);
+
+	if (!jsonPath.empty() && !writeJson(jsonPath, repeat, maxThreads))
+		std::cout << "Could not write \"" << jsonPath << "\"\n";
+	if (!csvPath.empty() && !writeCsv(csvPath))
+		std::cout << "Could not write \"" << csvPath << "\"\n";
+	if (Stats::isEnabled())
+	{
+		std::cout << "\n";
+		Stats::print(std::cout);
+	}
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include "../headers/Generator.h"
+#include <filesystem>
+#include <iostream>
+
+/**
+ * Writes a random water network in the CSV format of the bundled dataset,
+ * to be loaded with the --dataset option of the program.
+ * Usage: first_project_DA_generate FOLDER [options]
+ *  --pipes=N  Number of pipes (default 1000)
+ *  --stations=N, --cities=N, --reservoirs=N  Number of elements (default: pipes / 10, pipes / 50 and pipes / 200)
+ *  --seed=N  Seed of the random numbers, the same seed and options giving the same network (default 42)
+ *  --skew=X  Exponent of the Zipf distribution of the ends of the pipes, 0 for an even spread (default 0)
+ *  --bidirectional=X  Fraction of the pipes between stations that go both ways (default 0.3)
+ *  --supply=X  Total maximum delivery of the reservoirs over the total demand of the cities (default 1)
+*/
+int main(int argc, char **argv)
+{
+	std::string folder;
+	GeneratorOptions options;
+	int stations = -1, cities = -1, reservoirs = -1;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		size_t equals = arg.find('=');
+		std::string name = arg.substr(0, equals);
+		std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+		if (name == "--pipes")
+			options.pipes = atoi(value.c_str());
+		else if (name == "--stations")
+			stations = atoi(value.c_str());
+		else if (name == "--cities")
+			cities = atoi(value.c_str());
+		else if (name == "--reservoirs")
+			reservoirs = atoi(value.c_str());
+		else if (name == "--seed")
+			options.seed = strtoul(value.c_str(), nullptr, 10);
+		else if (name == "--skew")
+			options.degreeSkew = atof(value.c_str());
+		else if (name == "--bidirectional")
+			options.bidirectional = std::min(1.0, std::max(0.0, atof(value.c_str())));
+		else if (name == "--supply")
+			options.supplyRatio = std::max(0.0, atof(value.c_str()));
+		else if (arg.substr(0, 2) != "--" && folder.empty())
+			folder = arg;
+		else
+		{
+			folder.clear();
+			break;
+		}
+	}
+	if (folder.empty())
+	{
+		std::cout << "Usage: " << argv[0] << " FOLDER [--pipes=N] [--stations=N] [--cities=N] [--reservoirs=N]"
+				  << " [--seed=N] [--skew=X] [--bidirectional=X] [--supply=X]\n";
+		return 1;
+	}
+	options.stations = stations >= 0 ? stations : options.pipes / 10;
+	options.cities = cities >= 0 ? cities : options.pipes / 50;
+	options.reservoirs = reservoirs >= 0 ? reservoirs : options.pipes / 200;
+
+	std::error_code error;
+	std::filesystem::create_directories(folder, error);
+	NetworkGenerator generator(options);
+	if (!generator.writeCsv(folder))
+	{
+		std::cout << "Could not write the network to \"" << folder << "\"\n";
+		return 1;
+	}
+	std::cout << "Network with " << generator.numPipes() << " pipes written to \"" << folder << "\"\n";
+	return 0;
+}
@@ -0,0 +1,221 @@
+#include "../headers/Manager.h"
+#include "../headers/Hash.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+/**
+ * Reliability results of one connected part of the network, as saved in the cache.
+ * The file holds codes, turned into the indexes of the elements when it is read.
+*/
+struct CachedComponent {
+    RmResult pipes;
+    std::unordered_map<int, FlowComb> stations;
+};
+
+/**
+ * Splits the network in its connected parts, ignoring the direction of the pipes.
+ * Failures in one part never change the flow of another, so each one is cached on its own.
+ * The hash of a part covers its elements, their values and their pipes, in the order of the graph,
+ * and the flow of every arc of the part in the max flow of the network, from which failures start:
+ * the same network with another max flow may give other results.
+ * @param component Filled with the part of each vertex, by element index
+ * @note Complexity: O(V + E)
+ * @return Hash of each part
+*/
+std::vector<uint64_t> Manager::hashComponents(std::vector<int> &component)
+{
+    Span<Vertex *> vertices = network.getVertexSet();
+    component.assign(elementsById.size(), -1);
+    auto visit = [&component](Vertex *v, int part) {
+        int &current = component[v->getInfo()->getIndex()];
+        if (current != -1) return false;
+        current = part;
+        return true;
+    };
+
+    int count = 0;
+    for (Vertex *start : vertices){
+        if (!visit(start, count)) continue;
+        std::vector<Vertex *> stack = {start};
+        while (!stack.empty()){
+            Vertex *v = stack.back();
+            stack.pop_back();
+            for (ResidualArc arc : v->getResidualArcs()){
+                if (visit(arc.getOther(), count)) stack.push_back(arc.getOther());
+            }
+        }
+        count++;
+    }
+
+    std::vector<uint64_t> hashes(count, fnv1a((int)algorithm, FNV_OFFSET));
+    for (Vertex *v : vertices){
+        uint64_t &hash = hashes[component[v->getInfo()->getIndex()]];
+        Element *element = v->getInfo();
+        hash = fnv1a(element->getCode(), hash);
+        if (auto reservoir = dynamic_cast<Reservoir *>(element))
+            hash = fnv1a(reservoir->getMaxDelivery(), hash);
+        else if (auto city = dynamic_cast<City *>(element))
+            hash = fnv1a(city->getDemand(), hash);
+        for (Edge *e : v->getAdj()){
+            hash = fnv1a(e->getDest()->getInfo()->getCode(), hash);
+            hash = fnv1a(e->getWeight(), fnv1a(e->getReverse() != nullptr, hash));
+        }
+    }
+    for (int v = 0; v < flowNetwork.getNumVertex() - 2; v++){
+        uint64_t &hash = hashes[component[flowNetwork.getVertex(v)->getInfo()->getIndex()]];
+        for (int a = flowNetwork.begin(v); a < flowNetwork.end(v); a++)
+            hash = fnv1a(flowNetwork.flow(a), hash);
+    }
+    return hashes;
+}
+
+/**
+ * Index of the element with a code, -1 if there is none.
+*/
+static int findIndex(const std::unordered_map<std::string, Element *> &elements, const std::string &code)
+{
+    auto it = elements.find(code);
+    return it == elements.end() ? -1 : it->second->getIndex();
+}
+
+/**
+ * Reads the pairs "code flow" that follow a name in a cache line, sorted by city.
+ * Cities that are not in the network are left out.
+*/
+static FlowComb readFlows(std::istringstream &line, const std::unordered_map<std::string, Element *> &elements)
+{
+    FlowComb flows;
+    size_t count = 0;
+    line >> count;
+    for (size_t i = 0; i < count; i++){
+        std::string code;
+        Capacity flow;
+        line >> code >> flow;
+        int city = findIndex(elements, code);
+        if (city != -1) flows.push_back({city, flow});
+    }
+    std::sort(flows.begin(), flows.end());
+    return flows;
+}
+
+/**
+ * Writes a list of pairs "code flow" to a cache line.
+*/
+static void writeFlows(std::ofstream &out, const FlowComb &flows, const std::vector<Element *> &elements)
+{
+    out << ' ' << flows.size();
+    for (const auto& [city, flow] : flows)
+        out << ' ' << elements[city]->getCode() << ' ' << flow;
+    out << '\n';
+}
+
+/**
+ * Fills rmPipelines and rmPS like maintenancePipes and maintenancePS, reusing the results
+ * saved in a cache file by a previous run.
+ * Results are invalidated by connected part: a part is analysed again as a whole when any of its
+ * elements, pipes or arc flows changed, even for a single pipe. The cache is then saved with the
+ * current results.
+ * @param cachePath Cache file, empty to analyse everything without a cache
+ * @note Complexity: O(V + E) when nothing changed, O(NVE^2) for N failures to analyse
+*/
+void Manager::reliabilityAnalysis(const std::string &cachePath)
+{
+    TraceSpan span("reliabilityAnalysis", "reliability");
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+    rmPipelines.clear();
+    rmPS.assign(elementsById.size(), FlowComb());
+
+    std::vector<int> component;
+    std::vector<uint64_t> hashes = hashComponents(component);
+    auto partOf = [&component](Element *element) {
+        return component[element->getIndex()];
+    };
+
+    // Read the cache: a header line followed by the lines of each component
+    std::unordered_map<uint64_t, CachedComponent> cached;
+    std::ifstream in(cachePath);
+    std::string text;
+    if (std::getline(in, text) && text == "DA-RELIABILITY-CACHE 2"){
+        CachedComponent *current = nullptr;
+        while (std::getline(in, text)){
+            std::istringstream line(text);
+            std::string kind, code;
+            line >> kind;
+            if (kind == "component"){
+                uint64_t hash;
+                line >> std::hex >> hash;
+                current = &cached[hash];
+            }else if (current != nullptr && kind == "pipe"){
+                std::string orig, dest;
+                line >> orig >> dest;
+                int origIndex = findIndex(allElements, orig), destIndex = findIndex(allElements, dest);
+                if (origIndex != -1 && destIndex != -1)
+                    current->pipes[(uint64_t)origIndex << 32 | (uint32_t)destIndex] = readFlows(line, allElements);
+            }else if (current != nullptr && kind == "ps"){
+                line >> code;
+                int station = findIndex(allElements, code);
+                if (station != -1) current->stations[station] = readFlows(line, allElements);
+            }
+        }
+    }
+
+    // A component is reused if neither it nor its max flow changed
+    std::vector<bool> reuse(hashes.size(), false);
+    for (size_t c = 0; c < hashes.size(); c++){
+        auto it = cached.find(hashes[c]);
+        reuse[c] = it != cached.end();
+        if (!reuse[c]) continue;
+        rmPipelines.insert(it->second.pipes.begin(), it->second.pipes.end());
+        for (auto& [station, flows] : it->second.stations)
+            rmPS[station] = std::move(flows);
+    }
+
+    std::vector<Edge *> pipes = listPipes(), changedPipes;
+    for (Edge *pipe : pipes){
+        if (!reuse[partOf(pipe->getOrig()->getInfo())]) changedPipes.push_back(pipe);
+    }
+    std::vector<Station *> changedStations;
+    for (const auto& [code, station] : stations){
+        if (!reuse[partOf(station)]) changedStations.push_back(station);
+    }
+    analysePipes(changedPipes);
+    analyseStations(changedStations);
+
+    // Results cut short by cancelAnalyses are never saved
+    if (cachePath.empty() || cancelled)
+        return;
+
+    // Save every component with its results
+    std::vector<std::vector<Edge *>> componentPipes(hashes.size());
+    for (Edge *pipe : pipes){
+        if (rmPipelines.find(getPipeKey(pipe)) != rmPipelines.end())
+            componentPipes[partOf(pipe->getOrig()->getInfo())].push_back(pipe);
+    }
+    std::vector<std::vector<Station *>> componentStations(hashes.size());
+    for (const auto& [code, station] : stations){
+        if (!rmPS[station->getIndex()].empty())
+            componentStations[partOf(station)].push_back(station);
+    }
+
+    // Written to another file first, so an interrupted run never leaves half a cache
+    std::string tempPath = cachePath + ".tmp";
+    std::ofstream out(tempPath, std::ofstream::trunc);
+    out << "DA-RELIABILITY-CACHE 2\n";
+    for (size_t c = 0; c < hashes.size(); c++){
+        out << "component " << std::hex << hashes[c] << std::dec << '\n';
+        for (Edge *pipe : componentPipes[c]){
+            out << "pipe " << pipe->getOrig()->getInfo()->getCode() << ' ' << pipe->getDest()->getInfo()->getCode();
+            writeFlows(out, rmPipelines[getPipeKey(pipe)], elementsById);
+        }
+        for (Station *station : componentStations[c]){
+            out << "ps " << station->getCode();
+            writeFlows(out, rmPS[station->getIndex()], elementsById);
+        }
+    }
+    out.close();
+    if (out)
+        std::rename(tempPath.c_str(), cachePath.c_str());
+}
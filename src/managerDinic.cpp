@@ -0,0 +1,118 @@
+#include "../headers/Manager.h"
+#include <limits>
+
+/**
+ * Dinic's algorithm.
+ * Builds a level graph with a breadth-first search and saturates it with a blocking flow,
+ * repeating until the target can no longer be reached.
+ * Augments the flow already present in the residual graph.
+ * @note Complexity: O(V^2 * E)
+ * @return Flow added between source and target
+*/
+Capacity Manager::Dinic(FlowNetwork &flow, int source, int target)
+{
+    Capacity total = 0;
+    std::vector<int> level(flow.getNumVertex());
+    std::vector<int> current(flow.getNumVertex());
+
+    while (DinicBFS(flow, source, target, level)){
+        for (int v = 0; v < flow.getNumVertex(); v++){
+            current[v] = flow.begin(v);
+        }
+        total += DinicBlockingFlow(flow, source, target, level, current);
+    }
+    return total;
+}
+
+/**
+ * Breadth-first search that labels every vertex with its distance to the source
+ * using only arcs with available capacity.
+ * The search stops expanding once the level of the target is found.
+ * @note Complexity: O(V + E)
+ * @return If the target can be reached from the source
+*/
+bool Manager::DinicBFS(FlowNetwork &flow, int source, int target, std::vector<int> &level)
+{
+    std::queue<int> q;
+    q.push(source);
+
+    std::fill(level.begin(), level.end(), -1);
+    level[source] = 0;
+    uint64_t scanned = 0;
+    STATS_ADD(SearchPasses, 1);
+
+    while (!q.empty()){
+        int v = q.front();
+        q.pop();
+        if (level[target] != -1 && level[v] >= level[target]) break;
+
+        scanned += flow.end(v) - flow.begin(v);
+        for (int a = flow.begin(v); a < flow.end(v); a++){
+            int d = flow.head(a);
+            if (level[d] == -1 && flow.residual(a) > 0){
+                level[d] = level[v] + 1;
+                q.push(d);
+            }
+        }
+    }
+    STATS_ADD(EdgesScanned, scanned);
+    return level[target] != -1;
+}
+
+/**
+ * Finds a blocking flow in the level graph with an iterative depth-first search.
+ * Each vertex keeps the arc it is currently exploring, so arcs leading to dead ends
+ * or already saturated are never looked at again during the same phase.
+ * @note Complexity: O(V * E)
+ * @return Flow added between source and target
+*/
+Capacity Manager::DinicBlockingFlow(FlowNetwork &flow, int source, int target, const std::vector<int> &level, std::vector<int> &current)
+{
+    Capacity total = 0;
+    std::vector<int> path;
+    int v = source;
+    uint64_t paths = 0, scanned = 0;
+
+    while (true){
+        if (v == target){
+            Capacity bottleneck = std::numeric_limits<Capacity>::max();
+            for (int a : path){
+                bottleneck = std::min(bottleneck, flow.residual(a));
+            }
+            for (int a : path){
+                flow.push(a, bottleneck);
+            }
+            total += bottleneck;
+            paths++;
+
+            // Go back to the tail of the first saturated arc
+            size_t cut = 0;
+            while (flow.residual(path[cut]) > 0) cut++;
+            v = flow.head(flow.mate(path[cut]));
+            path.resize(cut);
+            continue;
+        }
+
+        int &a = current[v];
+        int first = a;
+        while (a < flow.end(v) && (flow.residual(a) <= 0 || level[flow.head(a)] != level[v] + 1)){
+            a++;
+        }
+        scanned += a - first + (a < flow.end(v) ? 1 : 0);
+
+        if (a < flow.end(v)){
+            path.push_back(a);
+            v = flow.head(a);
+        }else{
+            // Dead end, never come back to this vertex
+            if (v == source) break;
+            int back = path.back();
+            path.pop_back();
+            v = flow.head(flow.mate(back));
+            current[v]++;
+        }
+    }
+    STATS_ADD(AugmentingPaths, paths);
+    STATS_ADD(EdgesScanned, scanned);
+    return total;
+}
@@ -0,0 +1,159 @@
+#include "../headers/Manager.h"
+
+/**
+ * Sends up to a given amount of flow from one vertex to another through
+ * the shortest paths with available capacity, one path at a time.
+ * Used to move excess and deficit around while repairing a flow.
+ * @note Complexity: O(V * E^2)
+ * @return Flow actually sent
+*/
+Capacity Manager::SendFlow(FlowNetwork &flow, int from, int to, Capacity amount, PathSearch &search)
+{
+    Capacity sent = 0;
+    Capacity bottleneck;
+
+    while (sent < amount && (bottleneck = EdmondsBFS(flow, from, to, search))){
+        bottleneck = std::min(bottleneck, amount - sent);
+        for (int node = to; node != from; node = flow.head(flow.mate(search.path[node]))){
+            flow.push(search.path[node], bottleneck);
+        }
+        sent += bottleneck;
+    }
+    return sent;
+}
+
+/**
+ * Turns the flow of a residual graph whose capacities were lowered (or whose pipes and vertices
+ * were disabled) back into a valid flow, keeping as much of it as possible.
+ * Only the flow above the new capacity of an arc is cancelled. It is first rerouted between
+ * the two ends of the arc, what can not be rerouted is returned to the source from the tail
+ * of the arc and taken back from the target at the head.
+ * The flow is valid but not always maximum afterwards, so it should be augmented next.
+ * @note Complexity: O(E) when nothing has to be cancelled, O(V * E^2) per arc that has
+ * @return Change of the flow between source and target, never positive
+*/
+Capacity Manager::RepairFlow(FlowNetwork &flow, int source, int target)
+{
+    auto value = [&flow, target]() {
+        Capacity total = 0;
+        for (int a = flow.begin(target); a < flow.end(target); a++)
+            total -= flow.flow(a);
+        return total;
+    };
+
+    Capacity before = value();
+    std::vector<Capacity> excess;
+    PathSearch &search = PathSearch::get(flow.getNumVertex());
+
+    for (int v = 0; v < flow.getNumVertex(); v++){
+        for (int a = flow.begin(v); a < flow.end(v); a++){
+            Capacity over = flow.flow(a) - flow.capacity(a);
+            if (over <= 0) continue;
+
+            if (excess.empty()) excess.assign(flow.getNumVertex(), 0);
+            int w = flow.head(a);
+            flow.push(a, -over);
+            Capacity rerouted = v == source || w == target ? 0 : SendFlow(flow, v, w, over, search);
+            excess[v] += over - rerouted;
+            excess[w] -= over - rerouted;
+        }
+    }
+    if (excess.empty()) return 0;
+
+    for (int v = 0; v < flow.getNumVertex(); v++){
+        if (v == source || v == target) continue;
+        if (excess[v] > 0)
+            SendFlow(flow, v, source, excess[v], search);
+        else if (excess[v] < 0)
+            SendFlow(flow, target, v, -excess[v], search);
+    }
+    return value() - before;
+}
+
+/**
+ * Changes the capacity of a pipe and repairs the max flow of the network.
+ * A bidirectional pipe gets the new capacity in both directions.
+ * @note Complexity: O(E) plus the repair, see repairMaxFlow
+*/
+void Manager::updatePipeCapacity(Edge *pipe, Capacity capacity)
+{
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    bool cancel = updateCapacity(flowNetwork.findArc(pipe), capacity);
+    pipe->setWeight(capacity);
+    if (pipe->getReverse() != nullptr){
+        cancel |= updateCapacity(flowNetwork.findArc(pipe->getReverse()), capacity);
+        pipe->getReverse()->setWeight(capacity);
+    }
+    repairMaxFlow(cancel);
+}
+
+/**
+ * Changes the maximum delivery of a reservoir and repairs the max flow of the network.
+ * @note Complexity: O(1) plus the repair, see repairMaxFlow
+*/
+void Manager::updateMaxDelivery(Reservoir *reservoir, Capacity maxDelivery)
+{
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    int v = flowNetwork.findVertex(network.findVertex(reservoir));
+    bool cancel = updateCapacity(flowNetwork.sourceArc(v), maxDelivery);
+    reservoir->setMaxDelivery(maxDelivery);
+    repairMaxFlow(cancel);
+}
+
+/**
+ * Changes the demand of a city and repairs the max flow of the network.
+ * @note Complexity: O(1) plus the repair, see repairMaxFlow
+*/
+void Manager::updateDemand(City *city, Capacity demand)
+{
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    int v = flowNetwork.findVertex(network.findVertex(city));
+    bool cancel = updateCapacity(flowNetwork.sinkArc(v), demand);
+    city->setDemand(demand);
+    repairMaxFlow(cancel);
+}
+
+/**
+ * Sets the capacity of an arc of the residual graph of the network, and of its copies
+ * in the workspaces, which only take the flow of the network when they are reused.
+ * @return If the flow of the arc no longer fits and part of it has to be cancelled
+*/
+bool Manager::updateCapacity(int arc, Capacity capacity)
+{
+    flowNetwork.setCapacity(arc, capacity);
+    if (workspace.getNumVertex() != 0)
+        workspace.setCapacity(arc, capacity);
+    for (FlowNetwork &copy : workspaces){
+        if (copy.getNumVertex() != 0)
+            copy.setCapacity(arc, capacity);
+    }
+    return flowNetwork.flow(arc) > capacity;
+}
+
+/**
+ * Brings the max flow of the network up to date after capacities changed.
+ * When a capacity went down only the flow above it is cancelled, otherwise the current flow
+ * is simply augmented. The flow of the edges, maxFlows, deficitcities and totalNetworkFlow
+ * are updated. The reliability results (rmPipelines and rmPS) are not.
+ * @param cancel If some arc has more flow than its capacity
+ * @note Complexity: O(V * E^2) in the worst case, usually a few searches
+*/
+void Manager::repairMaxFlow(bool cancel)
+{
+    int source = flowNetwork.getSource();
+    int sink = flowNetwork.getSink();
+
+    if (cancel)
+        totalNetworkFlow += RepairFlow(flowNetwork, source, sink);
+    totalNetworkFlow += MaxFlow(flowNetwork, source, sink, getThreads());
+    flowNetwork.writeFlows();
+
+    readCityFlows();
+    citiesInDeficit();
+}
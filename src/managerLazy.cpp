@@ -0,0 +1,205 @@
+#include "../headers/Manager.h"
+#include <algorithm>
+#include <cstdlib>
+using namespace std;
+
+/**
+ * Failure waiting to be simulated by the prefetcher.
+ * Either arc is the arc of a pipe or vertex the vertex of a station, the other being -1.
+*/
+struct PendingFailure {
+    uint64_t key;
+    string name;
+    int arc;
+    int vertex;
+    Capacity flow;
+};
+
+/**
+ * Key of a station in the cache of failures, apart from the keys of the pipes (Manager::getPipeKey).
+*/
+static uint64_t getStationKey(Station *station)
+{
+    return uint64_t(1) << 63 | (uint32_t)station->getIndex();
+}
+
+/**
+ * Switches to the lazy reliability analysis: the failure of a pipe or station is only simulated
+ * the first time it is asked for, and the result is kept in a cache of limited size.
+ * A background thread fills the cache in the meantime, starting with the failures of the pipes
+ * and stations that carry the most water.
+ * @param memoCapacity Maximum number of results kept, 0 for no limit
+ * @note Complexity: O(V + E log E) here, the simulations run in the background
+*/
+void Manager::startLazyReliability(size_t memoCapacity)
+{
+    lazyReliability = true;
+    failureMemo.setCapacity(memoCapacity);
+    refreshReliability();
+}
+
+/**
+ * Brings the reliability results up to date after the network changed.
+ * In lazy mode the saved results are dropped and the prefetcher starts over,
+ * otherwise rmPipelines and rmPS are calculated again.
+ * @note Complexity: O(V + E log E) in lazy mode, O(NVE^2) otherwise
+*/
+void Manager::refreshReliability()
+{
+    if (!lazyReliability)
+    {
+        maintenancePipes();
+        maintenancePS();
+        return;
+    }
+    stopPrefetch();
+    failureMemo.clear();
+    startPrefetch();
+}
+
+/**
+ * Cities receiving less water when a pipe fails, and their new flow.
+ * A bidirectional pipe fails in both directions.
+ * @note Complexity: O(1) when the result is known, O(VE^2) otherwise
+*/
+FlowComb Manager::pipeFailure(Edge *pipe)
+{
+    if (!lazyReliability)
+    {
+        for (Edge *edge : {pipe, pipe->getReverse()})
+        {
+            auto it = edge == nullptr ? rmPipelines.end() : rmPipelines.find(getPipeKey(edge));
+            if (it != rmPipelines.end())
+                return it->second;
+        }
+        return FlowComb();
+    }
+    return lookupFailure(getPipeKey(pipe), [&]() { return getPipeCode(pipe); }, [&](FlowNetwork &flow, bool enabled)
+    {
+        flow.setPipeEnabled(flow.findArc(pipe), enabled);
+    });
+}
+
+/**
+ * Pipes listed by the reliability menu. In lazy mode every pipe is listed, their failures only
+ * being known once they are asked for. Otherwise only the pipes whose failure leaves some city
+ * short are, those found by maintenancePipes.
+ * @note Complexity: O(V + E)
+*/
+vector<Edge*> Manager::listReportedPipes()
+{
+    vector<Edge*> pipes = listPipes();
+    if (!lazyReliability)
+    {
+        pipes.erase(remove_if(pipes.begin(), pipes.end(), [this](Edge *pipe)
+        {
+            return pipeFailure(pipe).empty();
+        }), pipes.end());
+    }
+    return pipes;
+}
+
+/**
+ * Cities receiving less water when a pumping station fails, and their new flow.
+ * @note Complexity: O(1) when the result is known, O(VE^2) otherwise
+*/
+FlowComb Manager::stationFailure(Station *station)
+{
+    if (!lazyReliability)
+    {
+        size_t index = station->getIndex();
+        return index < rmPS.size() ? rmPS[index] : FlowComb();
+    }
+    return lookupFailure(getStationKey(station), [&]() { return station->getCode(); }, [&](FlowNetwork &flow, bool enabled)
+    {
+        flow.setVertexEnabled(flow.findVertex(network.findVertex(station)), enabled);
+    });
+}
+
+/**
+ * Result of a failure from the cache, simulated and saved when it is not there.
+ * @param key Key of the pipe or station that fails
+ * @param describe Name of the failure in the trace, only asked for while tracing
+ * @note Complexity: O(1) when the result is known, O(VE^2) otherwise
+*/
+FlowComb Manager::lookupFailure(uint64_t key, const function<string()> &describe,
+                                const function<void(FlowNetwork &flow, bool enabled)> &setEnabled)
+{
+    FlowComb result;
+    if (failureMemo.get(key, result))
+        return result;
+
+    TraceSpan span(Trace::isEnabled() ? describe() : string(), "reliability");
+    if (workspace.getNumVertex() == 0)
+        workspace = flowNetwork;
+    result = simulateOutage(workspace, flowNetwork, getCitiesToCheck(), setEnabled);
+    failureMemo.put(key, result);
+    return result;
+}
+
+/**
+ * Starts the background thread that simulates the failures not asked for yet.
+ * Failures are sorted by the flow of the pipe or station, the largest first, and the thread
+ * stops when the cache is full. It works on its own copy of the residual graph and of the
+ * flow of the cities, so the network may be read or changed while it runs.
+ * @note Complexity: O(V + E log E) here, O(NVE^2) in the background for N failures
+*/
+void Manager::startPrefetch()
+{
+    stopPrefetch();
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    vector<PendingFailure> failures;
+    for (Edge *pipe : listPipes())
+    {
+        int arc = flowNetwork.findArc(pipe);
+        failures.push_back({getPipeKey(pipe), getPipeCode(pipe), arc, -1, std::abs(flowNetwork.flow(arc))});
+    }
+    for (const auto& [code, station] : stations)
+    {
+        int v = flowNetwork.findVertex(network.findVertex(station));
+        Capacity through = 0;
+        for (int a = flowNetwork.begin(v); a < flowNetwork.end(v); a++)
+            through += max<Capacity>(0, flowNetwork.flow(a));
+        failures.push_back({getStationKey(station), code, -1, v, through});
+    }
+    stable_sort(failures.begin(), failures.end(), [](const PendingFailure &a, const PendingFailure &b)
+    {
+        return a.flow > b.flow;
+    });
+
+    stopPrefetching = false;
+    prefetcher = thread([this, failures = move(failures), citiesToCheck = getCitiesToCheck(), base = flowNetwork]()
+    {
+        Trace::nameThread("prefetcher");
+        FlowNetwork flow = base;
+        for (const PendingFailure &failure : failures)
+        {
+            if (stopPrefetching || failureMemo.full())
+                return;
+            if (failureMemo.contains(failure.key))
+                continue;
+            TraceSpan span(failure.name, "reliability");
+            FlowComb result = simulateOutage(flow, base, citiesToCheck, [&failure](FlowNetwork &flow, bool enabled)
+            {
+                if (failure.arc != -1)
+                    flow.setPipeEnabled(failure.arc, enabled);
+                else
+                    flow.setVertexEnabled(failure.vertex, enabled);
+            });
+            failureMemo.tryPut(failure.key, result);
+        }
+    });
+}
+
+/**
+ * Stops the background thread, waiting for the failure it is simulating.
+ * @note Complexity: O(VE^2) at most, the time of one failure
+*/
+void Manager::stopPrefetch()
+{
+    stopPrefetching = true;
+    if (prefetcher.joinable())
+        prefetcher.join();
+}
@@ -1,42 +1,135 @@
 #include "../headers/Manager.h"
-#include <fstream>
-#include <sstream>
+#include "../headers/Hash.h"
+#include "../headers/MappedFile.h"
 using namespace std;
 
+enum DatasetFile { RESERVOIRS, STATIONS, CITIES, PIPES };
+
+/**
+ * CSV files of the full dataset (first row) and of the small one (second row).
+*/
+static const char *const DATASET_FILES[2][4] = {
+    {"../dataset/Reservoir.csv", "../dataset/Stations.csv", "../dataset/Cities.csv", "../dataset/Pipes.csv"},
+    {"../dataset/small/Reservoirs_Madeira.csv", "../dataset/small/Stations_Madeira.csv",
+     "../dataset/small/Cities_Madeira.csv", "../dataset/small/Pipes_Madeira.csv"}
+};
+
+/**
+ * Names of the CSV files in a dataset folder, as in the full dataset.
+*/
+static const char *const DATASET_NAMES[4] = {"Reservoir.csv", "Stations.csv", "Cities.csv", "Pipes.csv"};
+
+/**
+ * Path of one of the CSV files of the dataset in use: the one in datasetDir when it is set,
+ * otherwise the bundled one.
+*/
+static string datasetFile(const string &datasetDir, bool useSmallSet, DatasetFile file)
+{
+    if (datasetDir.empty())
+        return DATASET_FILES[useSmallSet][file];
+    return datasetDir + "/" + DATASET_NAMES[file];
+}
+
+/**
+ * Creates a reservoir in the pool of the manager, which frees it.
+ * It still has to be added to the network (addElement).
+ * @note Complexity: O(1) amortized
+*/
+Reservoir *Manager::createReservoir(int id, const std::string &code, const std::string &name, const std::string &municipality, Capacity maxDelivery)
+{
+    return reservoirPool.create(id, code, name, municipality, maxDelivery);
+}
+
+/**
+ * Creates a pumping station in the pool of the manager, which frees it.
+ * @note Complexity: O(1) amortized
+*/
+Station *Manager::createStation(int id, const std::string &code)
+{
+    return stationPool.create(id, code);
+}
+
+/**
+ * Creates a city in the pool of the manager, which frees it.
+ * @note Complexity: O(1) amortized
+*/
+City *Manager::createCity(int id, const std::string &code, const std::string &name, Capacity demand, int population)
+{
+    return cityPool.create(id, code, name, demand, population);
+}
+
+/**
+ * Makes room for a number of elements of each kind, so creating them allocates a single block per kind.
+ * @note Complexity: O(1)
+*/
+void Manager::reserveElements(size_t reservoirs, size_t stations, size_t cities)
+{
+    reservoirPool.reserve(reservoirs);
+    stationPool.reserve(stations);
+    cityPool.reserve(cities);
+}
+
+/**
+ * Adds a loaded element to the network, giving it the next dense index.
+ * Its code is kept in allElements to find it from the input of the user.
+ * @note Complexity: O(1) on average
+*/
+void Manager::addElement(Element *element)
+{
+    element->setIndex(elementsById.size());
+    elementsById.push_back(element);
+    allElements[element->getCode()] = element;
+    network.addVertex(element);
+}
+
+/**
+ * Adds a loaded pipe to the network, counted once even when it goes both ways.
+ * @note Complexity: O(1)
+ * @return If the pipe was added, false when one of its ends is not in the network
+*/
+bool Manager::addPipe(Element *orig, Element *dest, Capacity capacity, bool bidirectional)
+{
+    bool added = bidirectional ? network.addBidirectionalEdge(orig, dest, capacity) : network.addEdge(orig, dest, capacity);
+    if (added)
+        numberEdges++;
+    return added;
+}
+
 /**
  * Loads all the reservoirs
  * @note Complexity: O(n) where n is the number of reservoirs
 */
 void Manager::loadReservoirs()
 {
-    std::ifstream file(useSmallSet ? "../dataset/small/Reservoirs_Madeira.csv" : "../dataset/Reservoir.csv");
+    STATS_TIMER(LoadReservoirs);
+    TraceSpan span("loadReservoirs", "load");
+    MappedFile file(datasetFile(datasetDir, useSmallSet, RESERVOIRS));
 
-    if(!file.is_open())
+    if(!file.isOpen())
 	{
         cout << "Error opening file Reservoir" << endl;
     }
 	else
 	{
-        string line;
-        getline(file,line);
+        CsvReader csv(file.getText());
+        csv.nextLine();
+        uint64_t rows = 0;
 
-        while(getline(file,line))
+        while(csv.nextLine())
 		{
-            string name, municipality, id, code, maxDelivery;
-            stringstream ss(line);
-
-            getline(ss, name, ',');
-            getline(ss, municipality, ',');
-            getline(ss, id, ',');
-            getline(ss, code, ',');
-            getline(ss, maxDelivery, '\r');
+            rows++;
+            string_view name = csv.nextField();
+            string_view municipality = csv.nextField();
+            int id = CsvReader::toInt(csv.nextField());
+            string code(csv.nextField());
+            Capacity maxDelivery = CsvReader::toCapacity(csv.nextField());
 
-            auto reservoir = new Reservoir(stoi(id),code, name, municipality, stoi(maxDelivery));
+            auto reservoir = createReservoir(id, code, string(name), string(municipality), maxDelivery);
 
             reservoirs[code] = reservoir;
-			allElements[code] = reservoir;
-            network.addVertex(reservoir);
+            addElement(reservoir);
         }
+        STATS_ADD(RowsLoaded, rows);
     }
 }
 
@@ -46,31 +139,32 @@ void Manager::loadReservoirs()
 */
 void Manager::loadStations()
 {
-    std::ifstream file(useSmallSet ? "../dataset/small/Stations_Madeira.csv" : "../dataset/Stations.csv");
+    STATS_TIMER(LoadStations);
+    TraceSpan span("loadStations", "load");
+    MappedFile file(datasetFile(datasetDir, useSmallSet, STATIONS));
 
-    if(!file.is_open())
+    if(!file.isOpen())
 	{
         cout << "Error opening file Stations" << endl;
     }
 	else
 	{
-        string line;
-        getline(file,line);
+        CsvReader csv(file.getText());
+        csv.nextLine();
+        uint64_t rows = 0;
 
-        while(getline(file,line))
+        while(csv.nextLine())
 		{
-            string id, code;
-            stringstream ss(line);
+            rows++;
+            int id = CsvReader::toInt(csv.nextField());
+            string code(csv.nextField());
 
-            getline(ss, id, ',');
-            getline(ss, code, '\r');
-
-            auto station = new Station(stoi(id),code);
+            auto station = createStation(id, code);
 
             stations[code] = station;
-			allElements[code] = station;
-            network.addVertex(station);
+            addElement(station);
         }
+        STATS_ADD(RowsLoaded, rows);
     }
 }
 
@@ -80,69 +174,93 @@ void Manager::loadStations()
 */
 void Manager::loadCities()
 {
-    std::ifstream file(useSmallSet ? "../dataset/small/Cities_Madeira.csv" : "../dataset/Cities.csv");
+    STATS_TIMER(LoadCities);
+    TraceSpan span("loadCities", "load");
+    MappedFile file(datasetFile(datasetDir, useSmallSet, CITIES));
 
-    if(!file.is_open())
+    if(!file.isOpen())
 	{
         cout << "Error opening file Cities" << endl;
     }
 	else
 	{
-        string line;
-        getline(file,line);
+        CsvReader csv(file.getText());
+        csv.nextLine();
+        uint64_t rows = 0;
 
-        while(getline(file,line))
+        while(csv.nextLine())
 		{
-            string name, id, code, demand, population;
-            stringstream ss(line);
-
-            getline(ss, name, ',');
-            getline(ss, id, ',');
-            getline(ss, code, ',');
-            getline(ss, demand, ',');
-            getline(ss, population, '\r');
+            rows++;
+            string_view name = csv.nextField();
+            int id = CsvReader::toInt(csv.nextField());
+            string code(csv.nextField());
+            Capacity demand = CsvReader::toCapacity(csv.nextField());
+            int population = CsvReader::toInt(csv.nextField());
 
-            auto city = new City(stoi(id),code, name, stoi(demand), stoi(population));
+            auto city = createCity(id, code, string(name), demand, population);
 
             cities[code] = city;
-			allElements[code] = city;
-            network.addVertex(city);
+            addElement(city);
         }
+        STATS_ADD(RowsLoaded, rows);
     }
 }
 
 /**
  * Loads all the pipes / edges of the graph
+ * Pipes with an end that is not a loaded element are skipped, and their number is reported.
  * @note Complexity: O(E)
 */
 void Manager::loadPipes()
 {
-    std::ifstream file(useSmallSet ? "../dataset/small/Pipes_Madeira.csv" : "../dataset/Pipes.csv");
+    STATS_TIMER(LoadPipes);
+    TraceSpan span("loadPipes", "load");
+    MappedFile file(datasetFile(datasetDir, useSmallSet, PIPES));
 
-    if(!file.is_open())
+    if(!file.isOpen())
 	{
         cout << "Error opening file Pipes" << endl;
     }
 	else
 	{
-        string line;
-        getline(file, line);
+        CsvReader csv(file.getText());
+        csv.nextLine();
+        uint64_t rows = 0, skipped = 0;
+        auto find = [this](const string &code) -> Element * {
+            auto it = allElements.find(code);
+            return it == allElements.end() ? nullptr : it->second;
+        };
 
-        while(getline(file, line))
+        while(csv.nextLine())
 		{
-            string source, destination, capacity, direction;
-            stringstream ss(line);
-
-            getline(ss, source, ',');
-            getline(ss, destination, ',');
-            getline(ss, capacity, ',');
-            getline(ss, direction, '\r');
-
-            numberEdges++;
-            if (direction == "0") 
-				network.addBidirectionalEdge(allElements[source], allElements[destination], stoi(capacity));
-            else
-				network.addEdge(allElements[source], allElements[destination], stoi(capacity));
+            rows++;
+            string source(csv.nextField());
+            string destination(csv.nextField());
+            Capacity capacity = CsvReader::toCapacity(csv.nextField());
+            string_view direction = csv.nextField();
+
+            if (!addPipe(find(source), find(destination), capacity, direction == "0"))
+                skipped++;
         }
+        if (skipped > 0)
+            cout << "Skipped " << skipped << " pipes with an unknown service point" << endl;
+        STATS_ADD(RowsLoaded, rows);
+    }
+}
+
+/**
+ * Hash of the contents of the CSV files of the dataset in use.
+ * A missing file counts as an empty one.
+ * @note Complexity: O(n) where n is the size of the files
+*/
+uint64_t Manager::hashDataset() const
+{
+    uint64_t hash = FNV_OFFSET;
+    for (DatasetFile fileType : {RESERVOIRS, STATIONS, CITIES, PIPES})
+    {
+        MappedFile file(datasetFile(datasetDir, useSmallSet, fileType));
+        hash = fnv1a(file.getText(), hash);
+        hash = fnv1a(file.getText().size(), hash);
     }
+    return hash;
 }
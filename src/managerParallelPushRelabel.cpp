@@ -0,0 +1,411 @@
+#include "../headers/Manager.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * Reusable barrier, every thread waits until all of them arrive.
+*/
+class Barrier {
+public:
+    Barrier(unsigned count) : count(count) {}
+    void wait();
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    unsigned count;
+    unsigned waiting = 0;
+    unsigned generation = 0;
+};
+
+void Barrier::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned current = generation;
+    if (++waiting == count){
+        waiting = 0;
+        generation++;
+        condition.notify_all();
+    }else{
+        condition.wait(lock, [this, current]{ return generation != current; });
+    }
+}
+
+/**
+ * Adds a value to an atomic number without locking.
+ * A compare and swap loop, as atomic doubles have no fetch_add before C++20.
+*/
+inline void atomicAdd(std::atomic<Capacity> &target, Capacity value)
+{
+    Capacity old = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(old, old + value, std::memory_order_relaxed)) {}
+}
+
+/**
+ * State of the synchronous parallel push-relabel algorithm.
+ * In every round all active vertices are discharged at the same time using the labels
+ * and excesses of the previous round. Pushes to a vertex only add to its incoming excess,
+ * which is merged once the round is over, and a vertex only pushes to an active neighbour
+ * when it wins against it, so two threads never use the same pipe in a round.
+ * Each thread discharges its own share of the active vertices and steals from the others
+ * once it runs out of work. Global relabels are done with a level synchronous breadth-first search.
+*/
+class ParallelState {
+public:
+    ParallelState(FlowNetwork &flow, unsigned threads);
+    void saturate(int source);
+    void run(int target, int fixed);
+    void store();
+    Capacity getExcess(int v) const;
+
+private:
+    /**
+     * Contiguous share of a list of vertices, consumed through an atomic cursor
+     * so other threads can steal from it.
+    */
+    struct Share {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+        char padding[64];
+    };
+
+    FlowNetwork &flow;
+    int n;
+    unsigned threads;
+    int target = -1;
+    int fixed = -1;
+
+    std::vector<std::atomic<Capacity>> flows;
+    std::vector<std::atomic<int>> label;
+    std::vector<int> newLabel;
+    std::vector<Capacity> excess;
+    std::vector<std::atomic<Capacity>> added;
+    std::vector<std::atomic<bool>> queued;
+
+    std::vector<int> active;
+    std::vector<std::vector<int>> found;
+    std::vector<Share> shares;
+    std::atomic<long> work{0};
+    int level = 0;
+    bool relabel = false;
+    Barrier barrier;
+
+    void worker(unsigned id);
+    void split(size_t size);
+    bool take(unsigned id, size_t &index);
+    void gather();
+    void globalRelabel(unsigned id);
+    void round(unsigned id);
+    void process(int v, std::vector<int> &next, long &scanned);
+    void push(int arc, Capacity amount);
+    Capacity residual(int arc) const;
+    bool isActive(int v) const;
+};
+
+ParallelState::ParallelState(FlowNetwork &flow, unsigned threads)
+    : flow(flow), n(flow.getNumVertex()), threads(threads),
+      flows(flow.getNumArcs()), label(n), newLabel(n, 0), excess(n, 0), added(n), queued(n),
+      found(threads), shares(threads), barrier(threads)
+{
+    for (int a = 0; a < flow.getNumArcs(); a++)
+        flows[a].store(flow.flow(a), std::memory_order_relaxed);
+    for (int v = 0; v < n; v++){
+        label[v].store(0, std::memory_order_relaxed);
+        added[v].store(0, std::memory_order_relaxed);
+        queued[v].store(false, std::memory_order_relaxed);
+    }
+}
+
+inline Capacity ParallelState::getExcess(int v) const {
+    return excess[v];
+}
+
+inline Capacity ParallelState::residual(int arc) const {
+    return flow.capacity(arc) - flows[arc].load(std::memory_order_relaxed);
+}
+
+inline void ParallelState::push(int arc, Capacity amount) {
+    int mate = flow.mate(arc);
+    flows[arc].store(flows[arc].load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    flows[mate].store(flows[mate].load(std::memory_order_relaxed) - amount, std::memory_order_relaxed);
+}
+
+inline bool ParallelState::isActive(int v) const {
+    return excess[v] > 0 && v != target && v != fixed;
+}
+
+/**
+ * Saturates every arc leaving the source, creating the initial preflow.
+ * @note Complexity: O(deg(source))
+*/
+void ParallelState::saturate(int source)
+{
+    for (int a = flow.begin(source); a < flow.end(source); a++){
+        Capacity r = residual(a);
+        if (r > 0){
+            push(a, r);
+            excess[source] -= r;
+            excess[flow.head(a)] += r;
+        }
+    }
+}
+
+/**
+ * Copies the flow found back into the residual graph.
+ * @note Complexity: O(E)
+*/
+void ParallelState::store()
+{
+    for (int a = 0; a < flow.getNumArcs(); a++){
+        if (a < flow.mate(a))
+            flow.push(a, flows[a].load(std::memory_order_relaxed) - flow.flow(a));
+    }
+}
+
+/**
+ * Splits a list of the given size in one contiguous share per thread.
+*/
+void ParallelState::split(size_t size)
+{
+    for (unsigned i = 0; i < threads; i++){
+        shares[i].next.store(size * i / threads, std::memory_order_relaxed);
+        shares[i].end = size * (i + 1) / threads;
+    }
+}
+
+/**
+ * Takes the next index of the list being processed, starting by the share of the thread
+ * and stealing from the shares of the others when it is over.
+ * @return If there was an index left
+*/
+bool ParallelState::take(unsigned id, size_t &index)
+{
+    for (unsigned i = 0; i < threads; i++){
+        Share &share = shares[(id + i) % threads];
+        if (share.next.load(std::memory_order_relaxed) >= share.end)
+            continue;
+        index = share.next.fetch_add(1, std::memory_order_relaxed);
+        if (index < share.end)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Joins the vertices found by every thread in the active list.
+ * Only called by one thread.
+*/
+void ParallelState::gather()
+{
+    active.clear();
+    for (auto &list : found){
+        active.insert(active.end(), list.begin(), list.end());
+        list.clear();
+    }
+}
+
+/**
+ * Sets every label to the exact distance to the target in the residual graph
+ * and rebuilds the active list. Each level of the search is explored by all threads,
+ * which claim vertices by changing their label atomically.
+ * @note Complexity: O(V + E)
+*/
+void ParallelState::globalRelabel(unsigned id)
+{
+    for (int v = n * id / threads; v < (int)(n * (id + 1) / threads); v++)
+        label[v].store(n, std::memory_order_relaxed);
+    barrier.wait();
+
+    if (id == 0){
+        label[target].store(0, std::memory_order_relaxed);
+        active.assign(1, target);
+        level = 0;
+        split(active.size());
+    }
+    barrier.wait();
+
+    uint64_t scanned = 0;
+    while (!active.empty()){
+        size_t index;
+        while (take(id, index)){
+            int v = active[index];
+            scanned += flow.end(v) - flow.begin(v);
+            for (int a = flow.begin(v); a < flow.end(v); a++){
+                int u = flow.head(a);
+                int expected = n;
+                if (u != fixed && residual(flow.mate(a)) > 0 &&
+                    label[u].load(std::memory_order_relaxed) == n &&
+                    label[u].compare_exchange_strong(expected, level + 1, std::memory_order_relaxed))
+                    found[id].push_back(u);
+            }
+        }
+        barrier.wait();
+        if (id == 0){
+            gather();
+            level++;
+            split(active.size());
+        }
+        barrier.wait();
+    }
+    STATS_ADD(EdgesScanned, scanned);
+    if (id == 0)
+        STATS_ADD(SearchPasses, 1);
+
+    for (int v = n * id / threads; v < (int)(n * (id + 1) / threads); v++){
+        if (isActive(v) && label[v].load(std::memory_order_relaxed) < n)
+            found[id].push_back(v);
+    }
+    barrier.wait();
+    if (id == 0){
+        gather();
+        split(active.size());
+        work.store(0, std::memory_order_relaxed);
+    }
+    barrier.wait();
+}
+
+/**
+ * Discharges a vertex using the labels and excesses of the previous round.
+ * The new label and the excess moved are only applied once the round is over.
+ * @note Complexity: O(V * deg(v))
+*/
+void ParallelState::process(int v, std::vector<int> &next, long &scanned)
+{
+    Capacity e = excess[v];
+    int d = label[v].load(std::memory_order_relaxed);
+    int current = d;
+
+    while (e > 0){
+        int relabelTo = n;
+        bool skipped = false;
+
+        for (int a = flow.begin(v); a < flow.end(v) && e > 0; a++){
+            int w = flow.head(a);
+            int dw = label[w].load(std::memory_order_relaxed);
+            Capacity r = residual(a);
+            bool admissible = r > 0 && current == dw + 1;
+            scanned++;
+
+            if (admissible && isActive(w)){
+                bool win = d == dw + 1 || d < dw - 1 || (d == dw && v < w);
+                if (!win){
+                    skipped = true;
+                    continue;
+                }
+            }
+            if (admissible){
+                Capacity delta = std::min(r, e);
+                push(a, delta);
+                e -= delta;
+                r -= delta;
+                atomicAdd(added[w], delta);
+                if (w != target && w != fixed && !queued[w].exchange(true, std::memory_order_relaxed))
+                    next.push_back(w);
+            }
+            if (r > 0 && dw >= current)
+                relabelTo = std::min(relabelTo, dw + 1);
+        }
+
+        if (e <= 0 || skipped)
+            break;
+        current = relabelTo;
+        if (current >= n)
+            break;
+    }
+
+    newLabel[v] = current;
+    atomicAdd(added[v], e - excess[v]);
+    if (e > 0 && current < n && !queued[v].exchange(true, std::memory_order_relaxed))
+        next.push_back(v);
+}
+
+/**
+ * Runs one round: discharges every active vertex and then applies the new labels and excesses.
+*/
+void ParallelState::round(unsigned id)
+{
+    long scanned = 0;
+    size_t index;
+    while (take(id, index))
+        process(active[index], found[id], scanned);
+    work.fetch_add(scanned, std::memory_order_relaxed);
+    STATS_ADD(EdgesScanned, scanned);
+    barrier.wait();
+
+    for (size_t i = active.size() * id / threads; i < active.size() * (id + 1) / threads; i++){
+        int v = active[i];
+        label[v].store(newLabel[v], std::memory_order_relaxed);
+        excess[v] += added[v].exchange(0, std::memory_order_relaxed);
+    }
+    barrier.wait();
+
+    for (int v : found[id]){
+        excess[v] += added[v].exchange(0, std::memory_order_relaxed);
+        queued[v].store(false, std::memory_order_relaxed);
+    }
+    barrier.wait();
+
+    if (id == 0){
+        excess[target] += added[target].exchange(0, std::memory_order_relaxed);
+        excess[fixed] += added[fixed].exchange(0, std::memory_order_relaxed);
+        gather();
+        split(active.size());
+        relabel = active.empty() || work.load(std::memory_order_relaxed) > 6L * n + flow.getNumArcs();
+    }
+    barrier.wait();
+}
+
+/**
+ * Work done by each thread: rounds until no active vertex is left,
+ * with a global relabel whenever enough work was done and before stopping.
+*/
+void ParallelState::worker(unsigned id)
+{
+    globalRelabel(id);
+    while (!active.empty()){
+        round(id);
+        if (relabel)
+            globalRelabel(id);
+    }
+}
+
+/**
+ * Moves all the excess that can reach the target into it, with the fixed vertex
+ * keeping the label n and never being processed.
+ * @note Complexity: O(V^2 * sqrt(E)) work, split by the threads
+*/
+void ParallelState::run(int target, int fixed)
+{
+    this->target = target;
+    this->fixed = fixed;
+
+    std::vector<std::thread> pool;
+    for (unsigned id = 1; id < threads; id++)
+        pool.emplace_back(&ParallelState::worker, this, id);
+    worker(0);
+    for (auto &thread : pool)
+        thread.join();
+}
+
+/**
+ * Parallel push-relabel algorithm.
+ * Like PushRelabel, a first phase finds a maximum preflow and a second one
+ * returns the excess left to the source.
+ * Augments the flow already present in the residual graph.
+ * @param threads Number of threads to use
+ * @note Complexity: O(V^2 * sqrt(E)) work, split by the threads
+ * @return Flow added between source and target
+*/
+Capacity Manager::ParallelPushRelabel(FlowNetwork &flow, int source, int target, unsigned threads)
+{
+    ParallelState state(flow, std::max(1u, threads));
+
+    state.saturate(source);
+    state.run(target, source);
+    state.run(source, target);
+    state.store();
+
+    return state.getExcess(target);
+}
@@ -3,54 +3,58 @@
 
 /**
  * Finds the farthest augmenting path between the source and the sink
+ * The path and distance of a vertex are only valid while it is marked in pathMarks,
+ * so each search starts without going through every vertex.
  * @note Complexity: O(n * V * E) where n is the number of reservoirs
  * @return Flow of the path
 */
-double Manager::FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& last)
+Capacity Manager::FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& last)
 {
+    STATS_TIMER(FarthestAugmentingPath);
+    uint64_t scanned = 0;
     // the values for the final flow
-    double finalFlow = 0;
+    Capacity finalFlow = 0;
     int actualTopDistance = 0;
+    pathMarks.resize(elementsById.size());
 
     // Go through each reservoir and detect more distant path
     for (const auto& [code, reservoir] : reservoirs) {
 
         // Reset the values for that reservoir
         int topDistance = 0;
-        double newFlow = 0;
+        Capacity newFlow = 0;
         Vertex* fakeLast;
 
         // find reservoir
         Vertex* source = network.findVertex(reservoir);
         // Calculate already sending flow
-        double alreadySending=0;
+        Capacity alreadySending=0;
         for (Edge* e : source->getAdj()){
             alreadySending+=e->getFlow();
         }
 
         // Create queue with reservoir and remaining sending flow
-        std::queue<std::pair<Vertex*, double>> q;
+        std::queue<std::pair<Vertex*, Capacity>> q;
         q.push({source, reservoir->getMaxDelivery()-alreadySending});
 
-        // Clean the graph 
-        for (Vertex* v : network.getVertexSet()) {
-            v->setPath(nullptr);
-            v->setDist(1);
-        }
+        // Clean the graph: the source is the only vertex with a distance and no vertex has a path yet
+        pathMarks.clear();
+        source->setDist(1);
+        STATS_ADD(SearchPasses, 1);
 
         while (!q.empty()) {
             Vertex* v = q.front().first;
-            double flow = q.front().second;
+            Capacity flow = q.front().second;
             q.pop();
             if (!flow) continue;
 
             // Save info of the last visited City
-            if (v->getInfo()->getCode()[0] == 'C') {
-                double totalIncoming = 0;
+            if (v->getInfo()->getType() == ElementType::City) {
+                Capacity totalIncoming = 0;
                 for (Edge* e : v->getIncoming()){
                     totalIncoming+=e->getFlow();
                 }
-                double availableSpace = dynamic_cast<City*>(v->getInfo())->getDemand()-totalIncoming;
+                Capacity availableSpace = static_cast<City*>(v->getInfo())->getDemand()-totalIncoming;
                 if (availableSpace){
                     fakeLast = v;
                     topDistance = v->getDist();
@@ -58,38 +62,39 @@ double Manager::FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& l
                 }
             }
 
-            // See outgoing edges
-            for (Edge* e : v->getAdj()) {
-                Vertex* d = e->getDest();
+            // See the outgoing edges, then the incoming ones backwards
+            for (ResidualArc arc : v->getResidualArcs()) {
+                scanned++;
+                Edge* e = arc.getEdge();
+                Vertex* d = arc.getOther();
+                if (pathMarks.isMarked(d->getInfo()->getIndex()))
+                    continue;
                 Edge* reverseEdge = e->getReverse();
-                // Only follow direct path if there is space and no reverse edge
-                // Or no flow in reverse Edge
-                if ((d->getPath() == nullptr) &&
-                    (e->getFlow() < e->getWeight()) && (!reverseEdge || reverseEdge->getFlow()==0)) {
-                    d->setPath(e);
-                    double possibleFlow = std::min(flow, e->getWeight() - e->getFlow());
-                    d->setDist(v->getDist() + 1);
-                    q.push({d, possibleFlow});
+                if (arc.isForward()) {
+                    // Only follow direct path if there is space and no reverse edge
+                    // Or no flow in reverse Edge
+                    if (arc.getResidual() > 0 && (!reverseEdge || reverseEdge->getFlow()==0)) {
+                        pathMarks.mark(d->getInfo()->getIndex());
+                        d->setPath(e);
+                        d->setDist(v->getDist() + 1);
+                        q.push({d, std::min(flow, arc.getResidual())});
+                    }
                 }
-            }
-
-
-            for (Edge* e : v->getIncoming()) {
-                Vertex* o = e->getOrig();
                 // Only if path has already flow 
                 // So its possible to redirect water
-                if ((o->getPath() == nullptr) && (e->getFlow() > 0)) {
-                    double possibleFlow;
-                    o->setPath(e);
+                else if (arc.getResidual() > 0) {
+                    Capacity possibleFlow;
+                    pathMarks.mark(d->getInfo()->getIndex());
+                    d->setPath(e);
 
-                    if (e->getReverse()){
+                    if (reverseEdge){
                         possibleFlow = std::min(flow, e->getWeight()+e->getFlow());
-                        o->setDist(v->getDist());
+                        d->setDist(v->getDist());
                     }else{
                         possibleFlow = std::min(flow, e->getFlow());
-                        o->setDist(v->getDist() -1);
+                        d->setDist(v->getDist() -1);
                     }
-                    q.push({o, possibleFlow});
+                    q.push({d, possibleFlow});
                 }
             }
         }
@@ -123,6 +128,9 @@ double Manager::FarthestAugmentingPath(std::list<Edge*>& biggestPath, Vertex*& l
             }
         }
     }
+    STATS_ADD(EdgesScanned, scanned);
+    if (finalFlow)
+        STATS_ADD(AugmentingPaths, 1);
     return finalFlow;
 }
 
@@ -142,10 +150,9 @@ std::pair<AnaliseResult, AnaliseResult> Manager::balanceNetwork()
             e->setFlow(0);
         }
     }
-    std::unordered_set<std::string> reservoirs;
     std::list<Edge*> biggestPath;
     Vertex* last;
-    double flow;
+    Capacity flow;
     while (flow = FarthestAugmentingPath(biggestPath, last)) {
         for (Edge* e : biggestPath) {
             if (last == e->getDest()) {
@@ -162,7 +169,6 @@ std::pair<AnaliseResult, AnaliseResult> Manager::balanceNetwork()
                 }
             }
         }
-        reservoirs.insert(last->getInfo()->getCode());
         biggestPath.clear();
     }
 
@@ -173,6 +179,7 @@ std::pair<AnaliseResult, AnaliseResult> Manager::balanceNetwork()
 
 /**
  * Analizes the balance of a graph.
+ * A network without pipes has nothing to balance, every result being 0.
  * @note Complexity: O(n * V * E^2), n being the number of reservoirs
  * @return Tuple about differences between capacity and flow <average, variance, max difference>
 */
@@ -184,6 +191,8 @@ std::tuple<double, double, double> Manager::AnalyzeBalance() {
 	double variance = 0;
 	double mean = 0;
 	double maxDiff = std::numeric_limits<double>::min();
+    if (numEdges == 0)
+        return {0, 0, 0};
 
     for (Vertex* v : network.getVertexSet()) {
         for (Edge* e : v->getAdj()) {
@@ -0,0 +1,246 @@
+#include "../headers/Manager.h"
+#include <algorithm>
+
+/**
+ * State of the highest-label push-relabel algorithm.
+ * Vertices are kept in buckets by label: one list with the active vertices
+ * (the ones with excess) and a doubly linked list with all of them, used by the gap heuristic.
+*/
+class HighestLabel {
+public:
+    HighestLabel(FlowNetwork &flow);
+    void saturate(int source);
+    void discharge(int target, int fixed);
+    Capacity getExcess(int v) const;
+    void addStats() const;
+
+private:
+    FlowNetwork &flow;
+    int n;
+    std::vector<Capacity> excess;
+    std::vector<int> label;
+    std::vector<int> current;
+    std::vector<int> activeHead, nextActive;
+    std::vector<int> allHead, nextAll, prevAll;
+    int maxActive = -1;
+    int maxLabel = -1;
+    long work = 0;
+    uint64_t scanned = 0, passes = 0; // For the statistics, added once at the end
+
+    void globalRelabel(int target, int fixed);
+    void addActive(int v);
+    void addLabel(int v);
+    void removeLabel(int v);
+    void gap(int k);
+    void process(int v, int target);
+};
+
+/**
+ * Allocates the state for a residual graph, every vertex starting without excess.
+*/
+HighestLabel::HighestLabel(FlowNetwork &flow)
+    : flow(flow), n(flow.getNumVertex()), excess(n, 0), label(n, 0), current(n, 0),
+      activeHead(n, -1), nextActive(n, -1), allHead(n, -1), nextAll(n, -1), prevAll(n, -1) {}
+
+inline Capacity HighestLabel::getExcess(int v) const {
+    return excess[v];
+}
+
+/**
+ * Adds the arcs looked at and the global relabels to the statistics.
+*/
+inline void HighestLabel::addStats() const {
+    STATS_ADD(SearchPasses, passes);
+    STATS_ADD(EdgesScanned, scanned);
+}
+
+/**
+ * Saturates every arc leaving the source, creating the initial preflow.
+ * @note Complexity: O(deg(source))
+*/
+void HighestLabel::saturate(int source)
+{
+    for (int a = flow.begin(source); a < flow.end(source); a++){
+        Capacity residual = flow.residual(a);
+        if (residual > 0){
+            flow.push(a, residual);
+            excess[source] -= residual;
+            excess[flow.head(a)] += residual;
+        }
+    }
+}
+
+inline void HighestLabel::addActive(int v) {
+    nextActive[v] = activeHead[label[v]];
+    activeHead[label[v]] = v;
+    maxActive = std::max(maxActive, label[v]);
+}
+
+inline void HighestLabel::addLabel(int v) {
+    int k = label[v];
+    prevAll[v] = -1;
+    nextAll[v] = allHead[k];
+    if (allHead[k] != -1) prevAll[allHead[k]] = v;
+    allHead[k] = v;
+    maxLabel = std::max(maxLabel, k);
+}
+
+inline void HighestLabel::removeLabel(int v) {
+    if (prevAll[v] != -1) nextAll[prevAll[v]] = nextAll[v];
+    else allHead[label[v]] = nextAll[v];
+    if (nextAll[v] != -1) prevAll[nextAll[v]] = prevAll[v];
+}
+
+/**
+ * Sets every label to the exact distance to the target in the residual graph,
+ * with a breadth-first search going backwards through the arcs.
+ * Vertices that can not reach the target get the label n and are left out of the buckets.
+ * @note Complexity: O(V + E)
+*/
+void HighestLabel::globalRelabel(int target, int fixed)
+{
+    std::fill(label.begin(), label.end(), n);
+    std::fill(activeHead.begin(), activeHead.end(), -1);
+    std::fill(allHead.begin(), allHead.end(), -1);
+    maxActive = maxLabel = -1;
+    work = 0;
+    passes++;
+
+    std::vector<int> queue;
+    queue.reserve(n);
+    queue.push_back(target);
+    label[target] = 0;
+
+    for (size_t i = 0; i < queue.size(); i++){
+        int v = queue[i];
+        scanned += flow.end(v) - flow.begin(v);
+        for (int a = flow.begin(v); a < flow.end(v); a++){
+            int u = flow.head(a);
+            if (label[u] == n && u != fixed && flow.residual(flow.mate(a)) > 0){
+                label[u] = label[v] + 1;
+                current[u] = flow.begin(u);
+                addLabel(u);
+                if (excess[u] > 0) addActive(u);
+                queue.push_back(u);
+            }
+        }
+    }
+}
+
+/**
+ * Gap heuristic: no vertex is left with label k,
+ * so the ones above it can no longer reach the target.
+ * @note Complexity: O(V)
+*/
+void HighestLabel::gap(int k)
+{
+    for (int j = k; j <= maxLabel; j++){
+        for (int v = allHead[j]; v != -1; v = nextAll[v]){
+            label[v] = n;
+        }
+        allHead[j] = -1;
+        activeHead[j] = -1;
+    }
+    maxLabel = k - 1;
+    maxActive = std::min(maxActive, k - 1);
+}
+
+/**
+ * Pushes the excess of a vertex through its admissible arcs,
+ * relabeling it whenever it runs out of them.
+ * Stops when there is no excess left or the vertex can no longer reach the target.
+ * @note Complexity: O(V * deg(v))
+*/
+void HighestLabel::process(int v, int target)
+{
+    while (excess[v] > 0){
+        for (int &a = current[v]; a < flow.end(v); a++){
+            scanned++;
+            int w = flow.head(a);
+            Capacity residual = flow.residual(a);
+            if (residual <= 0 || label[v] != label[w] + 1) continue;
+
+            Capacity delta = std::min(excess[v], residual);
+            flow.push(a, delta);
+            excess[v] -= delta;
+            if (excess[w] <= 0 && w != target) {
+                excess[w] += delta;
+                addActive(w);
+            } else {
+                excess[w] += delta;
+            }
+            if (excess[v] <= 0) return;
+        }
+
+        // No admissible arc left, relabel
+        int k = label[v];
+        if (allHead[k] == v && nextAll[v] == -1){
+            gap(k);
+            return;
+        }
+        removeLabel(v);
+
+        int newLabel = n;
+        for (int a = flow.begin(v); a < flow.end(v); a++){
+            if (flow.residual(a) > 0)
+                newLabel = std::min(newLabel, label[flow.head(a)] + 1);
+        }
+        work += flow.end(v) - flow.begin(v) + 12;
+        scanned += flow.end(v) - flow.begin(v);
+        current[v] = flow.begin(v);
+        label[v] = newLabel;
+        if (newLabel >= n){
+            label[v] = n;
+            return;
+        }
+        addLabel(v);
+    }
+}
+
+/**
+ * Moves all the excess that can reach the target into it, always working on the active vertex
+ * with the highest label. Labels are recalculated from scratch once enough relabeling work is done.
+ * The fixed vertex keeps the label n and is never processed.
+ * @note Complexity: O(V^2 * sqrt(E))
+*/
+void HighestLabel::discharge(int target, int fixed)
+{
+    int m = flow.getNumArcs();
+    label[fixed] = n;
+    globalRelabel(target, fixed);
+
+    while (maxActive >= 0){
+        int v = activeHead[maxActive];
+        if (v == -1){
+            maxActive--;
+            continue;
+        }
+        activeHead[maxActive] = nextActive[v];
+
+        process(v, target);
+
+        if (work * 2 > 6L * n + m){
+            globalRelabel(target, fixed);
+        }
+    }
+}
+
+/**
+ * Highest-label push-relabel algorithm with global relabeling and the gap heuristic.
+ * The first phase finds a maximum preflow, moving as much excess as possible into the target.
+ * The second one sends the excess that is left back to the source, turning it into a flow.
+ * Augments the flow already present in the residual graph.
+ * @note Complexity: O(V^2 * sqrt(E))
+ * @return Flow added between source and target
+*/
+Capacity Manager::PushRelabel(FlowNetwork &flow, int source, int target)
+{
+    HighestLabel state(flow);
+
+    state.saturate(source);
+    state.discharge(target, source);
+    state.discharge(source, target);
+    state.addStats();
+
+    return state.getExcess(target);
+}
@@ -4,298 +4,258 @@
 using namespace std;
 
 /**
- * This algorithm checks save which elements could potentially be affected
- * by the removal of a specific Reservoir, puts them in a set and runs the
- * max flow algorithm for these elements. In the end, it check which flows changes
- * for the potential affected element list.
+ * Removes a reservoir and checks which cities lose water.
+ * Starting from the max flow of the network, only the flow that came from the reservoir
+ * is cancelled (rerouted from other reservoirs when possible) and the result is augmented,
+ * instead of calculating the max flow again from scratch.
+ * The residual graph of the network is copied into the workspace by the first call only,
+ * the next ones just taking its flow (copyFlows), and the reservoir is only disabled there.
+ * The new flow of the cities is read from the workspace, the edges of the network keeping
+ * the max flow of the network.
  * @note Complexity: O(VE^2)
  * @return Vector of tuple <Vertex, old flow, new flow>
 */
-std::vector<std::tuple<Vertex *, double, double>> Manager::removeReservoir(Reservoir* reservoir)
+std::vector<std::tuple<Vertex *, Capacity, Capacity>> Manager::removeReservoir(Reservoir* reservoir)
 {
-    CalculateMaxFlow(network);
-
-    // Clean all the edges
-    for (Vertex* v : network.getVertexSet()){
-        for (Edge* e : v->getAdj()){
-            e->setSelected(false);
-        }
-        v->setVisited(false);
-    }
-
-    // Do BFS and store the affected pumping stations
-    std::unordered_set<Vertex*> affectedStations;
-
-    std::queue<Vertex*> q;
-    q.push(network.findVertex(reservoir));
-    network.findVertex(reservoir)->setVisited(true);
-
-    while (!q.empty()){
-        Vertex* v = q.front();
-        q.pop();
-
-        for (Edge* e : v->getAdj()){
-            // Record which pipes are the ones affected
-            e->setSelected(true);
-            Vertex* d = e->getDest();
-            if (!d->isVisited()){
-                d->setVisited(true);
-                affectedStations.insert(d);
-                q.push(d);
-            }
-        }
-    }
-
-    // Detect which stations/cities are the connecting ones
-    for (Vertex* station : affectedStations){
-        for (Edge* e : station->getAdj()){
-            e->setFlow(0);
-        }
-        bool connectingStation = false;
-        for (Edge* e : station->getIncoming()){
-            // If has not selected incoming edge then is connecting
-            if (!e->isSelected()){
-                connectingStation = true;
-            }else{
-                // Reset the flow of the selected edges
-                e->setFlow(0);
-            }
-        }
-        if (connectingStation) q.push(station);
-    }
-
-    // Use BFS to get the separating vertices
-    std::unordered_set<Vertex*> borderVertices;
-
-    while (!q.empty()){
-        Vertex* v = q.front();
-        q.pop();
+    TraceSpan span("removeReservoir " + reservoir->getCode(), "reliability");
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    FlowNetwork &flow = workspace;
+    if (flow.getNumVertex() == 0)
+        flow = flowNetwork;
+    else
+        flow.copyFlows(flowNetwork);
+    int v = flow.findVertex(network.findVertex(reservoir));
+    flow.setVertexEnabled(v, false);
+    RepairFlow(flow, flow.getSource(), flow.getSink());
+    MaxFlow(flow, flow.getSource(), flow.getSink(), getThreads());
+
+	std::vector<std::tuple<Vertex *, Capacity, Capacity>> result;
+	for (const auto& [code, city] : cities)
+	{
+		Vertex *aff = network.findVertex(city);
+		Capacity total = flow.inflow(flow.findVertex(aff));
+		Capacity oldTotal = maxFlows[city->getIndex()];
+		if (oldTotal > total)
+			result.push_back({aff, oldTotal, total});
+	}
+    flow.setVertexEnabled(v, true);
 
-        if (v->getIncoming().size()){
-            for (Edge* e : v->getIncoming()){
-                Vertex* o = e->getOrig();
+	return result;
+}
 
-                affectedStations.insert(o);
-                double flow = e->getFlow();
-                e->setFlow(0);
-                if (o->isVisited()){
-                    continue;
-                }
+/**
+ * Simulates a list of failures on copies of the residual graph of the network, in parallel.
+ * The workers of the pool and their copies of the residual graph are kept from one call to the next:
+ * a copy is made the first time a worker needs it, and then only takes the flow of the network.
+ * For every failure the worker disables the failing elements, repairs the max flow of the network
+ * and enables them again. Only the flow that went through the failing elements is cancelled,
+ * the rest of the network keeping the flow it had before the result is augmented.
+ * @param count Number of failures
+ * @param setEnabled Disables (enabled = false) or enables the elements of a failure in a residual graph
+ * Once cancelAnalyses is called, the failures not started yet are skipped and their results left empty.
+ * @param describe Name of a failure in the trace, only asked for while tracing
+ * @note Complexity: O(NVE^2) where N is the number of failures, split by the threads
+ * @return For each failure, the cities receiving less water than in maxFlows and their new flow
+*/
+vector<FlowComb> Manager::analyseOutages(size_t count, const function<void(FlowNetwork &flow, size_t index, bool enabled)> &setEnabled,
+                                         const function<string(size_t index)> &describe)
+{
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
 
-                // If edge is full
-                if (flow == e->getWeight()){
-                    borderVertices.insert(o);
-                }else{
-                    // If not remove it from being border
-                    if (borderVertices.find(o)!=borderVertices.end()) borderVertices.erase(o);
-                    // And add it to queue
-                    o->setVisited(true);
-                    q.push(o);
-                }
-            }
-        }else{
-            // Its a reservoir and then a border Vertice
-            borderVertices.insert(v);
-        }
+    vector<CityCheck> citiesToCheck = getCitiesToCheck();
+    ThreadPool &pool = getPool();
+    workspaces.resize(pool.size());
+    vector<FlowComb> results(count);
 
-        for (Edge* e : v->getAdj()){
-            Vertex* d = e->getDest();
-            double flow = e->getFlow();
-            e->setFlow(0);
-            if (d->isVisited()){
-                continue;
-            }
-            if (flow ||(d->getInfo()->getCode()[0] == 'C') ){
-                affectedStations.insert(d);
-                d->setVisited(true);
-                q.push(d);
-            }
-        }
-    }
-    
-    // Super source for edmondsKarp Algorithm
-    Element* superSource = new Element(0, "SS");
-    network.addVertex(superSource);
+    pool.run(count, [&](size_t i, unsigned worker)
+	{
+        if (cancelled)
+            return;
+        TraceSpan span(Trace::isEnabled() ? describe(i) : string(), "reliability");
+        if (workspaces[worker].getNumVertex() == 0)
+            workspaces[worker] = flowNetwork;
+        results[i] = simulateOutage(workspaces[worker], flowNetwork, citiesToCheck, [&](FlowNetwork &flow, bool enabled)
+		{
+            setEnabled(flow, i, enabled);
+        });
+    });
+    return results;
+}
 
-    // Add super sink
-    Element* superSink = new Element(0, "ST");
-    network.addVertex(superSink);
+/**
+ * Stops the analyses of failures running in other threads as soon as their workers end the
+ * failure they are simulating, instead of after the whole list: used before exiting, as
+ * their results are left incomplete and every later analysis is skipped.
+ * @note Complexity: O(1)
+*/
+void Manager::cancelAnalyses()
+{
+    cancelled = true;
+}
 
-    for (const auto& [code, sink]  : cities){
-        network.addEdge(sink, superSink, sink->getDemand());
-    }
+/**
+ * Cities to check after a failure, with their vertex in the residual graph and the flow
+ * they get when nothing fails, sorted by index so the results of a failure are too.
+ * @note Complexity: O(V)
+*/
+vector<CityCheck> Manager::getCitiesToCheck()
+{
+    vector<CityCheck> citiesToCheck;
+    for (const auto& [city, oldFlow] : listCities(maxFlows, false))
+        citiesToCheck.emplace_back(city, flowNetwork.findVertex(network.findVertex(elementsById[city])), oldFlow);
+    return citiesToCheck;
+}
 
-    // Connect superSource to the different border Vertices
-    for (Vertex* v: borderVertices){
+/**
+ * Simulates one failure on a copy of the residual graph of the network.
+ * The copy takes the flow of base, the failing elements are disabled, the max flow is repaired
+ * and the elements are enabled again, leaving the copy ready for the next failure.
+ * @param flow Copy of the residual graph of the network, with the same arcs as base
+ * @param base Residual graph holding the max flow of the network
+ * @param citiesToCheck Result of getCitiesToCheck
+ * @param setEnabled Disables (enabled = false) or enables the failing elements in the copy
+ * @note Complexity: O(VE^2)
+ * @return The cities receiving less water than when nothing fails and their new flow
+*/
+FlowComb Manager::simulateOutage(FlowNetwork &flow, const FlowNetwork &base, const vector<CityCheck> &citiesToCheck,
+                                 const function<void(FlowNetwork &flow, bool enabled)> &setEnabled)
+{
+    FlowComb result;
+    flow.copyFlows(base);
+    setEnabled(flow, false);
+    RepairFlow(flow, flow.getSource(), flow.getSink());
+    MaxFlow(flow, flow.getSource(), flow.getSink(), 1);
 
-        std::string code = v->getInfo()->getCode();
-        double capacity;
-        switch (code[0])
-        {
-        case 'P':
-            for (Edge* e : v->getIncoming()){
-                capacity += e->getFlow();
-            }
-            break;
-        case 'R':
-            capacity = dynamic_cast<Reservoir*>(v->getInfo())->getMaxDelivery();
-            break;
-        default:
-            break;
+    for (const auto& [city, v, oldFlow] : citiesToCheck)
+	{
+        Capacity newFlow = 0;
+        for (int a = flow.begin(v); a < flow.end(v); a++)
+		{
+            int in = flow.mate(a);
+            if (flow.getEdge(in) != nullptr && flow.flow(in) > 0)
+                newFlow += flow.flow(in);
         }
-        network.addEdge(superSource, v->getInfo(), capacity);
+        if (newFlow < oldFlow)
+            result.push_back({city, newFlow});
     }
-
-    auto ssiIter = affectedStations.insert(network.findVertex(superSink));
-    auto ssoIter = affectedStations.insert(network.findVertex(superSource));
-
-    EdmondsKarp(network, superSource, superSink, affectedStations);
-
-    // Clean network
-    network.removeVertex(superSource);
-    network.removeVertex(superSink);
-	affectedStations.erase(ssiIter.first);
-	affectedStations.erase(ssoIter.first);
-
-    delete superSink;
-    delete superSource;
-
-	std::vector<std::tuple<Vertex *, double, double>> result;
-	for (auto aff : affectedStations)
-	{
-		City *city = dynamic_cast<City *>(aff->getInfo());
-		if (city == nullptr)
-			continue;
-		double total = 0;
-		for (auto i : aff->getIncoming())
-			total += i->getFlow();
-		double oldTotal = maxFlows[city->getCode()];
-		if (oldTotal > total)
-			result.push_back({aff, oldTotal, total});
-	}
-
-	return result;
+    setEnabled(flow, true);
+    return result;
 }
 
 /**
  * For each station, this algorithm removes it and edges related to it from the network
  * and runs the Max flow algorithm on the modified network.
- * After, it compares flows to check which cities are affected by the removal
- * @note Complexity: O(NVE^2) where N is the number of stations
+ * After, it compares flows to check which cities are affected by the removal.
+ * Stations are disabled in the residual graph instead of being removed from a copy of the network.
+ * @note Complexity: O(NVE^2) where N is the number of pumping stations, split by the threads
 */
 void Manager::maintenancePS()
 {
-    int n = 0;
+    rmPS.assign(elementsById.size(), FlowComb());
+    vector<Station*> stationList;
     for (const auto& [stationCode, station] : this->stations)
-	{
-		Graph temp = network.getCopy();
-        unordered_map<string,int> flowswithoutps;
-        unordered_map<Element*,double> outgoing, incoming;
-
-        auto networkStation = network.findVertex(station);
-
-        temp.removeVertex(station);
-        
-        CalculateMaxFlow(temp);  //edmonds
-        for(const auto& [cityCode, city] : this->cities)
-		{
-            int flow = 0;
-            for(auto in : temp.findVertex(city)->getIncoming())
-                flow += in->getFlow();
-            flowswithoutps[cityCode] = flow;
-        }
+        stationList.push_back(station);
+    analyseStations(stationList);
+}
 
-        unordered_map<string, int> affectedcities;
-        for(const auto& [cityCode,city] : this->cities)
-		{
-            if(flowswithoutps[cityCode] < maxFlows[cityCode])
-                affectedcities[cityCode] = flowswithoutps[cityCode];
-        }
+/**
+ * Removes each of the given stations and saves the affected cities in rmPS.
+ * @note Complexity: O(NVE^2) where N is the number of stations, split by the threads
+*/
+void Manager::analyseStations(const vector<Station*> &stationList)
+{
+    TraceSpan span("maintenancePS", "reliability");
+    rmPS.resize(elementsById.size());
+    vector<FlowComb> results = analyseOutages(stationList.size(), [&](FlowNetwork &flow, size_t i, bool enabled)
+	{
+        flow.setVertexEnabled(flow.findVertex(network.findVertex(stationList[i])), enabled);
+    }, [&](size_t i)
+	{
+        return "station " + stationList[i]->getCode();
+    });
 
-        if(!affectedcities.empty())
-		{
-            rmPS[stationCode] = affectedcities;
-        }
-        
-		for (auto vtx : temp.getVertexSet())
-		{
-			for (auto edg : vtx->getAdj())
-				delete edg;
-			delete vtx;
-		}
+    for (size_t i = 0; i < stationList.size(); i++)
+	{
+        if (!results[i].empty())
+            rmPS[stationList[i]->getIndex()] = move(results[i]);
     }
 }
 
 /**
  * For each pipe/edge, this algorithm removes it from the network
  * and runs the Max flow algorithm on the modified network.
- * After, it compares flows to check which cities are affected by the removal
- * @note Complexity: O(NV^2E^3) where N is the number of stations
+ * After, it compares flows to check which cities are affected by the removal.
+ * Pipes are disabled in the residual graph instead of being removed from a copy of the network,
+ * a bidirectional pipe being a single pair of arcs, disabled in both directions at once.
+ * @note Complexity: O(NVE^2) where N is the number of pipes, split by the threads
 */
 void Manager::maintenancePipes()
 {
-    int n = 0;
-    for(auto element : network.getVertexSet())
+    rmPipelines.clear();
+    analysePipes(listPipes());
+}
+
+/**
+ * Every pipe of the network once: a bidirectional pipe is removed in both directions
+ * at once, so only its first edge is listed, the one leaving the vertex visited first.
+ * @note Complexity: O(V + E)
+*/
+vector<Edge*> Manager::listPipes()
+{
+    vector<Edge*> pipes;
+    vector<bool> visited(elementsById.size(), false);
+    for (auto element : network.getVertexSet())
 	{
-        for(auto edge : element->getAdj())
+        for (auto edge : element->getAdj())
 		{
-			Graph temp = network.getCopy();
-
-            Element* orig = edge->getOrig()->getInfo();
-            Element* dest = edge->getDest()->getInfo();
-            double w = edge->getWeight();
-            bool reverse = false;
-
-            if(edge->getReverse() != nullptr)
-			{
-                string code = dest->getCode() + " --- " + orig->getCode();
-                if(rmPipelines.find(code) != rmPipelines.end())
-				{
-					for (auto vtx : temp.getVertexSet())
-					{
-						for (auto edg : vtx->getAdj())
-							delete edg;
-						delete vtx;
-					}
-					continue;
-				}
-                    
-                temp.removeEdge(edge->getDest()->getInfo(),edge->getOrig()->getInfo());
-                reverse = true; 
-            }
-            temp.removeEdge(edge->getOrig()->getInfo(),edge->getDest()->getInfo());
-        
-            unordered_map<string,int> flowswithoutpipe;
-            unordered_map<Element*,double> incoming;
+            Edge *reverse = edge->getReverse();
+            if (reverse != nullptr && (visited[edge->getDest()->getInfo()->getIndex()] || (edge->getDest() == element && reverse < edge)))
+                continue;
+            pipes.push_back(edge);
+        }
+        visited[element->getInfo()->getIndex()] = true;
+    }
+    return pipes;
+}
 
-            CalculateMaxFlow(temp);  //edmonds
-            for (const auto& [cityCode,city] : this->cities)
-			{
-                int flow = 0;
-                for(auto incoming : temp.findVertex(city)->getIncoming())
-                    flow += incoming->getFlow();
-                flowswithoutpipe[cityCode] = flow;
-            }
+/**
+ * Name of a pipe shown to the user.
+*/
+string Manager::getPipeCode(Edge *pipe)
+{
+    return pipe->getOrig()->getInfo()->getCode() + " --- " + pipe->getDest()->getInfo()->getCode();
+}
 
-			for (auto vtx : temp.getVertexSet())
-			{
-				for (auto edg : vtx->getAdj())
-					delete edg;
-				delete vtx;
-			}
+/**
+ * Key of a pipe in rmPipelines: the indexes of its origin and destination.
+ * @note Complexity: O(1)
+*/
+uint64_t Manager::getPipeKey(Edge *pipe)
+{
+    return (uint64_t)pipe->getOrig()->getInfo()->getIndex() << 32 | (uint32_t)pipe->getDest()->getInfo()->getIndex();
+}
 
-            unordered_map<string, int> affectedcities;
-            for (const auto& [cityCode,city] : this->cities)
-			{
-                if (flowswithoutpipe[cityCode] < maxFlows[cityCode])
-                    affectedcities[cityCode] = flowswithoutpipe[cityCode];
-            }
+/**
+ * Removes each of the given pipes and saves the affected cities in rmPipelines.
+ * @note Complexity: O(NVE^2) where N is the number of pipes, split by the threads
+*/
+void Manager::analysePipes(const vector<Edge*> &pipes)
+{
+    TraceSpan span("maintenancePipes", "reliability");
+    vector<FlowComb> results = analyseOutages(pipes.size(), [&](FlowNetwork &flow, size_t i, bool enabled)
+	{
+        flow.setPipeEnabled(flow.findArc(pipes[i]), enabled);
+    }, [&](size_t i)
+	{
+        return "pipe " + getPipeCode(pipes[i]);
+    });
 
-            if(!affectedcities.empty())
-			{
-                string code = orig->getCode() + " --- " + dest->getCode();
-                rmPipelines[code] = affectedcities;
-            }
-        }
+    for (size_t i = 0; i < pipes.size(); i++)
+	{
+        if (!results[i].empty())
+            rmPipelines[getPipeKey(pipes[i])] = move(results[i]);
     }
 }
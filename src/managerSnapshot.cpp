@@ -0,0 +1,336 @@
+#include "../headers/Manager.h"
+#include "../headers/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+/**
+ * Binary snapshot of a network, read straight from a memory mapped file.
+ * Layout, every number in the byte order of the machine that wrote it:
+ *  SnapshotHeader
+ *  ElementRecord[numElements]   Elements in the order of the vertices of the graph
+ *  EdgeRecord[numEdges]         Pipes in the order they were created
+ *  char[stringsSize]            Codes and names, referenced by offset and length
+ * The flow of the pipes is the max flow of the network when the snapshot was saved.
+ * The header keeps the hash of the CSV files it was made from (Manager::hashDataset),
+ * so a snapshot older than the files is not loaded.
+ * Any change to the layout must increase SNAPSHOT_VERSION.
+ * Capacities, flows, demands and deliveries are stored as Capacity values, so builds with
+ * fractional capacities use their own version.
+*/
+static const char SNAPSHOT_MAGIC[8] = {'D', 'A', 'S', 'N', 'A', 'P', 'S', 'H'};
+static const uint32_t SNAPSHOT_VERSION = std::is_integral_v<Capacity> ? 6 : 7;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+enum ElementKind : uint32_t { RESERVOIR, STATION, CITY };
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t numElements;
+    uint32_t numEdges;
+    uint64_t stringsSize;
+    Capacity totalNetworkFlow;
+    double numberEdges;
+    uint64_t datasetHash;
+};
+
+struct SnapshotString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct ElementRecord {
+    uint32_t kind;
+    int32_t id;
+    int32_t population;
+    uint32_t padding;
+    Capacity amount; // Max delivery of a reservoir or demand of a city
+    SnapshotString code;
+    SnapshotString name;
+    SnapshotString municipality;
+};
+
+struct EdgeRecord {
+    uint32_t orig;
+    uint32_t dest;
+    int32_t reverse; // Index of the reverse pipe, -1 if the pipe is one way
+    uint32_t padding;
+    Capacity capacity;
+    Capacity flow;
+};
+
+/**
+ * Orders the pipes of a graph so that adding them one by one gives every vertex
+ * the same outgoing and incoming lists it has now.
+ * Each pipe must come after the previous one in the outgoing list of its origin
+ * and in the incoming list of its destination, so the pipes are sorted topologically.
+ * @note Complexity: O(V + E)
+*/
+static std::vector<Edge *> creationOrder(const Graph &graph)
+{
+    std::unordered_map<Edge *, int> index;
+    std::vector<Edge *> edges;
+    for (Vertex *v : graph.getVertexSet()){
+        for (Edge *e : v->getAdj()){
+            index[e] = edges.size();
+            edges.push_back(e);
+        }
+    }
+
+    std::vector<int> nextOut(edges.size(), -1), nextIn(edges.size(), -1), before(edges.size(), 0);
+    for (Vertex *v : graph.getVertexSet()){
+        Span<Edge *> adj = v->getAdj(), incoming = v->getIncoming();
+        for (size_t i = 1; i < adj.size(); i++){
+            nextOut[index[adj[i - 1]]] = index[adj[i]];
+            before[index[adj[i]]]++;
+        }
+        for (size_t i = 1; i < incoming.size(); i++){
+            nextIn[index[incoming[i - 1]]] = index[incoming[i]];
+            before[index[incoming[i]]]++;
+        }
+    }
+
+    std::vector<int> queue;
+    for (size_t e = 0; e < edges.size(); e++){
+        if (before[e] == 0) queue.push_back(e);
+    }
+    std::vector<Edge *> order;
+    for (size_t i = 0; i < queue.size(); i++){
+        int e = queue[i];
+        order.push_back(edges[e]);
+        for (int next : {nextOut[e], nextIn[e]}){
+            if (next != -1 && --before[next] == 0) queue.push_back(next);
+        }
+    }
+    return order;
+}
+
+/**
+ * Saves the network and its max flow to a binary snapshot.
+ * The max flow is calculated first if it was not yet.
+ * @note Complexity: O(V + E * d) where d is the highest degree of a vertex
+ * @return If the file could be written
+*/
+bool Manager::saveSnapshot(const std::string &path)
+{
+    TraceSpan span("saveSnapshot", "load");
+    if (flowNetwork.getNumVertex() == 0)
+        maxFlowCities();
+
+    std::string strings;
+    auto addString = [&strings](const std::string &text) {
+        SnapshotString result = {(uint32_t)strings.size(), (uint32_t)text.size()};
+        strings += text;
+        return result;
+    };
+
+    Span<Vertex *> vertices = network.getVertexSet();
+    std::unordered_map<Vertex *, uint32_t> vertexIndex;
+    std::vector<ElementRecord> elements;
+    for (Vertex *v : vertices){
+        vertexIndex[v] = elements.size();
+        Element *element = v->getInfo();
+        ElementRecord record = {};
+        record.id = element->getId();
+        record.code = addString(element->getCode());
+        if (auto reservoir = dynamic_cast<Reservoir *>(element)){
+            record.kind = RESERVOIR;
+            record.amount = reservoir->getMaxDelivery();
+            record.name = addString(reservoir->getName());
+            record.municipality = addString(reservoir->getMunicipality());
+        }else if (auto city = dynamic_cast<City *>(element)){
+            record.kind = CITY;
+            record.amount = city->getDemand();
+            record.population = city->getPopulation();
+            record.name = addString(city->getName());
+        }else{
+            record.kind = STATION;
+        }
+        elements.push_back(record);
+    }
+
+    std::vector<Edge *> order = creationOrder(network);
+    std::unordered_map<Edge *, int32_t> edgeIndex;
+    for (size_t i = 0; i < order.size(); i++)
+        edgeIndex[order[i]] = i;
+
+    std::vector<EdgeRecord> edges;
+    for (Edge *e : order){
+        EdgeRecord record = {};
+        record.orig = vertexIndex[e->getOrig()];
+        record.dest = vertexIndex[e->getDest()];
+        record.reverse = e->getReverse() ? edgeIndex[e->getReverse()] : -1;
+        record.capacity = e->getWeight();
+        // Flow of the max flow, the edges may hold another one (after balancing the network)
+        int arc = flowNetwork.findArc(e);
+        record.flow = std::max<Capacity>(0, flowNetwork.flow(arc));
+        edges.push_back(record);
+    }
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.numElements = elements.size();
+    header.numEdges = edges.size();
+    header.stringsSize = strings.size();
+    header.totalNetworkFlow = totalNetworkFlow;
+    header.numberEdges = numberEdges;
+    header.datasetHash = hashDataset();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(elements.data()), elements.size() * sizeof(ElementRecord));
+    file.write(reinterpret_cast<const char *>(edges.data()), edges.size() * sizeof(EdgeRecord));
+    file.write(strings.data(), strings.size());
+    return file.good();
+}
+
+/**
+ * Checks that the records of a snapshot only refer to strings, elements and pipes inside it,
+ * that every element has a known kind and that reverse pipes point at each other.
+ * Done before anything is loaded, so a damaged snapshot is rejected without changing the manager.
+ * @param kinds Filled with the number of elements of each kind
+ * @note Complexity: O(V + E)
+ * @return If every record is valid
+*/
+static bool checkRecords(std::string_view data, const SnapshotHeader &header, size_t elementsStart, size_t edgesStart,
+                         size_t (&kinds)[3])
+{
+    auto validString = [&header](SnapshotString s) {
+        return (uint64_t)s.offset + s.length <= header.stringsSize;
+    };
+    for (uint32_t i = 0; i < header.numElements; i++){
+        ElementRecord record;
+        memcpy(&record, data.data() + elementsStart + i * sizeof(ElementRecord), sizeof(record));
+        if (record.kind != RESERVOIR && record.kind != STATION && record.kind != CITY)
+            return false;
+        kinds[record.kind]++;
+        if (!validString(record.code) || !validString(record.name) || !validString(record.municipality))
+            return false;
+    }
+
+    std::vector<EdgeRecord> edges(header.numEdges);
+    if (!edges.empty())
+        memcpy(edges.data(), data.data() + edgesStart, edges.size() * sizeof(EdgeRecord));
+    for (uint32_t i = 0; i < header.numEdges; i++){
+        const EdgeRecord &record = edges[i];
+        if (record.orig >= header.numElements || record.dest >= header.numElements)
+            return false;
+        if (record.reverse == -1)
+            continue;
+        if (record.reverse < 0 || (uint32_t)record.reverse >= header.numEdges)
+            return false;
+        const EdgeRecord &reverse = edges[record.reverse];
+        if (reverse.reverse != (int32_t)i || reverse.orig != record.dest || reverse.dest != record.orig)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Loads a network and its max flow from a binary snapshot, instead of the CSV files.
+ * Meant for an empty manager: replaces the load functions and maxFlowCities.
+ * A snapshot made from other CSV files than the current ones is stale and not loaded.
+ * The elements of each kind are created in a single block of their pool.
+ * @note Complexity: O(V + E), plus reading the CSV files to hash them
+ * @return If the snapshot could be read, otherwise the manager is left unchanged
+*/
+bool Manager::loadSnapshot(const std::string &path)
+{
+    TraceSpan span("loadSnapshot", "load");
+    MappedFile file(path);
+    std::string_view data = file.getText();
+
+    SnapshotHeader header;
+    if (!file.isOpen() || data.size() < sizeof(header)){
+        std::cout << "Error opening snapshot " << path << std::endl;
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER){
+        std::cout << "Snapshot " << path << " is not a version " << SNAPSHOT_VERSION << " snapshot" << std::endl;
+        return false;
+    }
+
+    size_t elementsStart = sizeof(header);
+    size_t edgesStart = elementsStart + (size_t)header.numElements * sizeof(ElementRecord);
+    size_t stringsStart = edgesStart + (size_t)header.numEdges * sizeof(EdgeRecord);
+    if (data.size() != stringsStart + header.stringsSize){
+        std::cout << "Snapshot " << path << " is truncated" << std::endl;
+        return false;
+    }
+    size_t kinds[3] = {};
+    if (!checkRecords(data, header, elementsStart, edgesStart, kinds)){
+        std::cout << "Snapshot " << path << " is corrupt" << std::endl;
+        return false;
+    }
+    if (header.datasetHash != hashDataset()){
+        std::cout << "Snapshot " << path << " is older than the CSV files" << std::endl;
+        return false;
+    }
+    std::string_view strings = data.substr(stringsStart);
+    auto getString = [&strings](SnapshotString s) {
+        return std::string(strings.substr(s.offset, s.length));
+    };
+
+    std::vector<Vertex *> vertices;
+    vertices.reserve(header.numElements);
+    network.reserve(header.numElements, header.numEdges);
+    reserveElements(kinds[RESERVOIR], kinds[STATION], kinds[CITY]);
+    for (uint32_t i = 0; i < header.numElements; i++){
+        ElementRecord record;
+        memcpy(&record, data.data() + elementsStart + i * sizeof(ElementRecord), sizeof(record));
+        std::string code = getString(record.code);
+        Element *element;
+        switch (record.kind){
+        case RESERVOIR: {
+            auto reservoir = createReservoir(record.id, code, getString(record.name), getString(record.municipality), record.amount);
+            reservoirs[code] = reservoir;
+            element = reservoir;
+            break;
+        }
+        case CITY: {
+            auto city = createCity(record.id, code, getString(record.name), record.amount, record.population);
+            cities[code] = city;
+            element = city;
+            break;
+        }
+        default: {
+            auto station = createStation(record.id, code);
+            stations[code] = station;
+            element = station;
+            break;
+        }
+        }
+        addElement(element);
+        vertices.push_back(network.findVertex(element));
+    }
+
+    std::vector<Edge *> edges;
+    edges.reserve(header.numEdges);
+    for (uint32_t i = 0; i < header.numEdges; i++){
+        EdgeRecord record;
+        memcpy(&record, data.data() + edgesStart + i * sizeof(EdgeRecord), sizeof(record));
+        Edge *edge = vertices[record.orig]->addEdge(vertices[record.dest], record.capacity);
+        edge->setFlow(record.flow);
+        edges.push_back(edge);
+    }
+    for (uint32_t i = 0; i < header.numEdges; i++){
+        int32_t reverse;
+        memcpy(&reverse, data.data() + edgesStart + i * sizeof(EdgeRecord) + offsetof(EdgeRecord, reverse), sizeof(reverse));
+        if (reverse >= 0) edges[i]->setReverse(edges[reverse]);
+    }
+
+    numberEdges = header.numberEdges;
+    totalNetworkFlow = header.totalNetworkFlow;
+    buildFlowNetwork(network, flowNetwork);
+    flowNetwork.readFlows();
+    readCityFlows();
+    return true;
+}
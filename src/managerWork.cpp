@@ -1,135 +1,172 @@
 #include "../headers/Manager.h"
 #include <limits.h>
 #include <list>
+#include <thread>
 
 /**
- * Calculates the Max Flow in the network by using the Edmonds-Kart algorithm.
- * @note Complexity: O(VE^2)
- * @return Max flow for the current network
+ * Number of threads available for parallel work, capped by maxThreads.
 */
-double Manager::CalculateMaxFlow(Graph &network)
+unsigned Manager::getThreads() const
 {
-    // Add super source
-    Element* superSource = new Element(0, "SS");
-    network.addVertex(superSource);
+    unsigned threads = maxThreads ? maxThreads : std::thread::hardware_concurrency();
+    return std::max(1u, threads);
+}
 
-    for (const auto& [code, source]  : reservoirs){
-        network.addEdge(superSource, source, source->getMaxDelivery());
+/**
+ * Pool of getThreads() workers, started again only when maxThreads changed.
+ * @note Complexity: O(1), O(T) to start T threads
+*/
+ThreadPool &Manager::getPool()
+{
+    if (pool == nullptr || pool->size() != getThreads()){
+        pool.reset();
+        pool.reset(new ThreadPool(getThreads()));
+        workspaces.clear();
     }
+    return *pool;
+}
 
-    // Add super sink
-    Element* superSink = new Element(0, "ST");
-    network.addVertex(superSink);
+/**
+ * Builds the residual graph of a network, connecting the super source to every reservoir
+ * and every city to the super sink.
+ * When the residual graph of the main network is built again, its copies in the workspaces,
+ * whose arcs no longer match, are dropped.
+ * @note Complexity: O(V + E)
+*/
+void Manager::buildFlowNetwork(Graph &network, FlowNetwork &flow)
+{
+    FlowNetwork::Terminals sources, sinks;
 
+    for (const auto& [code, source] : reservoirs){
+        sources.push_back({network.findVertex(source), source->getMaxDelivery()});
+    }
     for (const auto& [code, sink] : cities){
-        network.addEdge(sink, superSink, sink->getDemand());
+        sinks.push_back({network.findVertex(sink), sink->getDemand()});
     }
-
-    // Clean graph
-    for (Vertex* v : network.getVertexSet()){
-        for (Edge* e : v->getAdj()){
-            e->setFlow(0);
-        }
-        v->setPath(nullptr);
+    flow.build(network, sources, sinks);
+    if (&flow == &flowNetwork){
+        workspace = FlowNetwork();
+        workspaces.clear();
     }
+}
 
-    std::unordered_set<Vertex*> affected;
-    for (auto e : allElements){
-        affected.insert(network.findVertex(e.second));
-    }
-    affected.insert(network.findVertex(superSource));
-    affected.insert(network.findVertex(superSink));
+/**
+ * Calculates the Max Flow in the network by using the selected algorithm.
+ * The residual graph of the main network is only built once, other networks get a temporary one.
+ * The resulting flow is saved in the edges of the network.
+ * @note Complexity: O(VE^2)
+ * @return Max flow for the current network
+*/
+Capacity Manager::CalculateMaxFlow(Graph &network)
+{
+    FlowNetwork temporary;
+    FlowNetwork &flow = &network == &this->network ? flowNetwork : temporary;
 
-    EdmondsKarp(network, superSource, superSink, affected);
+    if (flow.getNumVertex() == 0)
+        buildFlowNetwork(network, flow);
+    else
+        flow.resetFlows();
 
-    double total = 0;
-    Vertex* superSinkVertex = network.findVertex(superSink);
-    for (Edge* e : superSinkVertex->getIncoming()){
-        total += e->getFlow();
-    }
+    Capacity total = MaxFlow(flow, flow.getSource(), flow.getSink(), getThreads());
+    flow.writeFlows();
 
     // Just to check result 
     //std::cout << "Max flow obtained was: " << total << std::endl;
 
-    // Clean graph
-    network.removeVertex(superSource);
-    network.removeVertex(superSink);
-    delete superSink;
-    delete superSource;
-
     return total;
 }
 
+/**
+ * Augments the flow between source and target with the selected algorithm.
+ * Networks with at least parallelThreshold vertices use the parallel push-relabel
+ * algorithm when more than one thread is available.
+ * @param threads Number of threads the algorithm may use
+ * @note Complexity: depends on the algorithm, O(V * E^2) at most
+ * @return Flow added between source and target
+*/
+Capacity Manager::MaxFlow(FlowNetwork &flow, int source, int target, unsigned threads)
+{
+    if (algorithm == FlowAlgorithm::ParallelPushRelabel ||
+        (parallelThreshold > 0 && flow.getNumVertex() >= parallelThreshold && threads > 1))
+        return ParallelPushRelabel(flow, source, target, threads);
+
+    switch (algorithm)
+    {
+    case FlowAlgorithm::Dinic:
+        return Dinic(flow, source, target);
+    case FlowAlgorithm::PushRelabel:
+        return PushRelabel(flow, source, target);
+    case FlowAlgorithm::EdmondsKarp:
+    default:
+        return EdmondsKarp(flow, source, target);
+    }
+}
+
 /**
  * Edmonds-Karp algorithm.
+ * Augments the flow already present in the residual graph.
  * @note Complexity: O(V * E^2)
+ * @return Flow added between source and target
 */
-void Manager::EdmondsKarp(Graph &network, Element* source, Element* target, const std::unordered_set<Vertex*>& affected)
+Capacity Manager::EdmondsKarp(FlowNetwork &flow, int source, int target)
 {
-    double new_flow;
-
-    auto sc = network.findVertex(source);
-    auto tg = network.findVertex(target);
-
-    while ((new_flow = EdmondsBFS(network, sc, tg, affected))){
-        Vertex* node = tg;
-        while (node != sc){
-            Vertex* next;
-            Edge* e = node->getPath();
-            if (e->getDest() == node){
-                next = e->getOrig();
-                e->setFlow(e->getFlow() + new_flow);
-            }else{
-                next = e->getDest();
-                e->setFlow(e->getFlow() - new_flow);
-            }
-            node = next;
+    STATS_TIMER(EdmondsKarp);
+    Capacity total = 0;
+    Capacity new_flow;
+    uint64_t paths = 0;
+    PathSearch &search = PathSearch::get(flow.getNumVertex());
+
+    while ((new_flow = EdmondsBFS(flow, source, target, search))){
+        for (int node = target; node != source; node = flow.head(flow.mate(search.path[node]))){
+            flow.push(search.path[node], new_flow);
         }
+        total += new_flow;
+        paths++;
     }
+    STATS_ADD(AugmentingPaths, paths);
+    return total;
 }
 
 /**
  * Breadth-first search used in the Edmonds-Kart algorithm to find 
  * the shortest path that has available capacity.
- * @note Complexity: O(V * E)
- * @return Always returns 0
+ * The arc used to reach each vertex is saved in search.path. Reached vertices are
+ * marked in the current epoch of search.reached, so nothing is reset between searches.
+ * @note Complexity: O(V + E), only counting the vertices and arcs reached
+ * @return Flow that can be sent through the path, 0 if there is none
 */
-double Manager::EdmondsBFS(Graph &network, Vertex* source, Vertex* target, const std::unordered_set<Vertex*>& affected)
+Capacity Manager::EdmondsBFS(FlowNetwork &flow, int source, int target, PathSearch &search)
 {
-    std::queue<std::pair<Vertex*, double>> q;
-    q.push({source,std::numeric_limits<double>::max()});
-
-    for (Vertex* v : network.getVertexSet()){
-        v->setPath(nullptr);
-    }
-
-    while (!q.empty()){
-        Vertex* v = q.front().first;
-        double flow = q.front().second;
-        q.pop();
-
-        for (Edge* e : v->getAdj()){
-            Vertex* d = e->getDest();
-            if (affected.find(d) == affected.end()) continue;
-            Edge* reverseEdge = e->getReverse();
-            if ((d->getPath()== nullptr) && (e->getFlow() < e->getWeight()) && (reverseEdge ? reverseEdge->getFlow()==0:true)){
-                d->setPath(e);
-                double new_flow = std::min(flow, e->getWeight()-e->getFlow());
-                if (d == target) return new_flow;
-                q.push({d, new_flow});
-            }
-        }
-        for (Edge* e : v->getIncoming()){
-            Vertex* o = e->getOrig();
-            if (affected.find(o) == affected.end()) continue;
-            if ((o->getPath()== nullptr) && (e->getFlow() > 0)){
-                o->setPath(e);
-                double new_flow = std::min(flow, e->getFlow());
-                if (o == target) return new_flow;
-                q.push({o, new_flow});
+    std::vector<std::pair<int, Capacity>> &q = search.queue;
+    q.clear();
+    q.push_back({source, std::numeric_limits<Capacity>::max()});
+
+    search.reached.clear();
+    search.reached.mark(source);
+    uint64_t scanned = 0;
+    STATS_ADD(SearchPasses, 1);
+
+    for (size_t next = 0; next < q.size(); next++){
+        int v = q[next].first;
+        Capacity bottleneck = q[next].second;
+
+        scanned += flow.end(v) - flow.begin(v);
+        for (int a = flow.begin(v); a < flow.end(v); a++){
+            int d = flow.head(a);
+            Capacity residual = flow.residual(a);
+            if (!search.reached.isMarked(d) && residual > 0){
+                search.reached.mark(d);
+                search.path[d] = a;
+                Capacity new_flow = std::min(bottleneck, residual);
+                if (d == target){
+                    STATS_ADD(EdgesScanned, scanned);
+                    return new_flow;
+                }
+                q.push_back({d, new_flow});
             }
         }
     }
+    STATS_ADD(EdgesScanned, scanned);
     return 0;
 }
 
@@ -139,26 +176,59 @@ double Manager::EdmondsBFS(Graph &network, Vertex* source, Vertex* target, const
 */
 void Manager::maxFlowCities()
 { 
+    TraceSpan span("maxFlowCities", "maxflow");
     totalNetworkFlow = CalculateMaxFlow(network);
+    readCityFlows();
+}
+
+/**
+ * Saves the flow reaching each city, taken from the edges of the network, in maxFlows.
+ * @note Complexity: O(V + E)
+*/
+void Manager::readCityFlows()
+{
+    maxFlows.assign(elementsById.size(), 0);
     for (const auto& [code, city] : this->cities)
 	{
-    	int flow = 0;
-    	for (auto incoming : network.findVertexByCode(code)->getIncoming())
+    	Capacity flow = 0;
+    	for (auto incoming : network.findVertex(city)->getIncoming())
     	    flow += incoming->getFlow();
-		maxFlows[code] = flow;
+		maxFlows[city->getIndex()] = flow;
     }
 }
 
 /**
- * Goes through the resulting map from maxFlowCites to save which cities are in deficit of water.
+ * Goes through the results of maxFlowCites to save which cities are in deficit of water.
  * @note Complexity: O(n) where n is the number of cities
 */
 void Manager::citiesInDeficit()
 { 
+    TraceSpan span("citiesInDeficit", "maxflow");
+    deficitcities.assign(elementsById.size(), 0);
     for (const auto& [code, city] : this->cities)
 	{
-    	int maxFlowCity = maxFlows[code];
+    	Capacity maxFlowCity = maxFlows[city->getIndex()];
     	if (maxFlowCity < city->getDemand())
-			deficitcities[code] = city->getDemand() - maxFlowCity;
+			deficitcities[city->getIndex()] = city->getDemand() - maxFlowCity;
+    }
+}
+
+/**
+ * Cities with their value in a vector indexed by element, in the order they were loaded.
+ * @param values Value of each element, such as maxFlows or deficitcities
+ * @param skipZero If the cities whose value is 0 are left out
+ * @note Complexity: O(V)
+*/
+FlowComb Manager::listCities(const std::vector<Capacity> &values, bool skipZero) const
+{
+    FlowComb result;
+    for (Element *element : elementsById)
+	{
+        if (element->getType() != ElementType::City)
+            continue;
+        Capacity value = (size_t)element->getIndex() < values.size() ? values[element->getIndex()] : 0;
+        if (value != 0 || !skipZero)
+            result.push_back({element->getIndex(), value});
     }
+    return result;
 }
@@ -1,4 +1,6 @@
 #include "../headers/Ui.h"
+#include <array>
+#include <memory>
 
 #ifdef _WIN32
 #include "windows.h"
@@ -6,41 +8,242 @@
 
 /**
  * Sets the console output mode to UTF8 if the platform is windows.
- * If the is an argument after the executable, the small dataset will be loaded.
+ * Options start with "--", any other argument after the executable loads the small dataset.
+ * Available options:
+ *  --solver=edmonds-karp|dinic|push-relabel|parallel-push-relabel  Algorithm used to calculate the max flow
+ *  --parallel-threshold=N  Vertices from which the parallel solver is used, 0 to never switch
+ *  --threads=N  Maximum number of worker threads, 0 to use all available
+ *  --dataset=FOLDER  Loads Reservoir.csv, Stations.csv, Cities.csv and Pipes.csv from a folder instead of the bundled dataset
+ *  --snapshot=FILE  Loads the network and its max flow from a binary snapshot instead of the CSV files
+ *  --convert=FILE  Saves the CSV files (and their max flow) as a binary snapshot and exits
+ *  --no-cache  Analyses every failure again instead of reusing the reliability cache
+ *  --lazy[=N]  Analyses each failure when it is first shown, keeping at most N results (default 1024, 0 for no limit)
+ *  --trace=FILE  Writes a timeline of the loaders, the startup stages and the reliability analyses in the Chrome trace format
+ *  --stats  Collects statistics of the solvers from the start, shown in the statistics menu (printed at the end with --convert)
 */
 int main(int argc, char **argv)
 {
 #ifdef _WIN32
 	SetConsoleOutputCP(CP_UTF8);
 #endif
-	(void)argv;
-    UI(argc > 1);
+	Options options;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg == "--solver=edmonds-karp")
+			options.algorithm = FlowAlgorithm::EdmondsKarp;
+		else if (arg == "--solver=dinic")
+			options.algorithm = FlowAlgorithm::Dinic;
+		else if (arg == "--solver=push-relabel")
+			options.algorithm = FlowAlgorithm::PushRelabel;
+		else if (arg == "--solver=parallel-push-relabel")
+			options.algorithm = FlowAlgorithm::ParallelPushRelabel;
+		else if (arg.substr(0, 21) == "--parallel-threshold=")
+			options.parallelThreshold = atoi(arg.substr(21).c_str());
+		else if (arg.substr(0, 10) == "--threads=")
+			options.threads = std::max(0, atoi(arg.substr(10).c_str()));
+		else if (arg.substr(0, 10) == "--dataset=")
+			options.dataset = arg.substr(10);
+		else if (arg.substr(0, 11) == "--snapshot=")
+			options.snapshot = arg.substr(11);
+		else if (arg.substr(0, 10) == "--convert=")
+			options.convert = arg.substr(10);
+		else if (arg == "--no-cache")
+			options.useCache = false;
+		else if (arg == "--lazy")
+			options.lazy = true;
+		else if (arg.substr(0, 7) == "--lazy=")
+		{
+			options.lazy = true;
+			options.memoCapacity = std::max(0, atoi(arg.substr(7).c_str()));
+		}
+		else if (arg == "--stats")
+			options.stats = true;
+		else if (arg.substr(0, 8) == "--trace=")
+			options.trace = arg.substr(8);
+		else if (arg.substr(0, 2) == "--")
+		{
+			std::cout << "Unknown option \"" << arg << "\"\n"
+					  << "Usage: " << argv[0] << " [--solver=edmonds-karp|dinic|push-relabel|parallel-push-relabel]"
+					  << " [--parallel-threshold=N] [--threads=N] [--dataset=FOLDER] [--snapshot=FILE | --convert=FILE] [--no-cache | --lazy[=N]] [--stats] [--trace=FILE] [small]\n";
+			return 1;
+		}
+		else
+			options.useSmallSet = true;
+	}
+	Stats::setEnabled(options.stats);
+	if (!options.trace.empty())
+	{
+		if (!Trace::start(options.trace))
+		{
+			std::cout << "Could not write the trace \"" << options.trace << "\"\n";
+			return 1;
+		}
+		Trace::nameThread("main");
+	}
+	if (!options.convert.empty())
+	{
+		Manager manager(options.useSmallSet);
+		manager.algorithm = options.algorithm;
+		manager.parallelThreshold = options.parallelThreshold;
+		manager.maxThreads = options.threads;
+		manager.datasetDir = options.dataset;
+		manager.loadCities();
+		manager.loadReservoirs();
+		manager.loadStations();
+		manager.loadPipes();
+		if (!manager.saveSnapshot(options.convert))
+		{
+			std::cout << "Could not write the snapshot \"" << options.convert << "\"\n";
+			return 1;
+		}
+		std::cout << "Snapshot saved to \"" << options.convert << "\"\n";
+		if (options.stats)
+		{
+			std::cout << "\n";
+			Stats::print(std::cout);
+		}
+		return 0;
+	}
+    UI ui(options);
     return 0;
 }
 
+static const char *const STAGE_NAMES[STAGES] = {"Loading", "Max flow", "Cities in deficit", "Reliability analysis"};
+
 /**
  * Constructor for the Ui class.
- * Creates a manager and loads up all the information while also pre-calculating some information.
+ * Creates a manager and loads up all the information, then shows the main menu
+ * while the rest is pre-calculated in the background (see startPipeline).
+ * The network comes from a snapshot when one is given and can be read, otherwise from the CSV files.
  * Also save the time it takes to load the system.
 */
-UI::UI(bool useSmallSet) : manager(Manager(useSmallSet))
+UI::UI(const Options &options) : manager(Manager(options.useSmallSet))
 {
+	manager.algorithm = options.algorithm;
+	manager.parallelThreshold = options.parallelThreshold;
+	manager.maxThreads = options.threads;
+	manager.datasetDir = options.dataset;
 	auto start = std::chrono::high_resolution_clock::now();
-    manager.loadCities();
-	manager.loadReservoirs();
-	manager.loadStations();
-	manager.loadPipes();
-	manager.maxFlowCities();
-	manager.citiesInDeficit();
-	manager.maintenancePipes();
-	manager.maintenancePS();
+	bool fromSnapshot;
+	{
+		TraceSpan span(STAGE_NAMES[LOAD], "startup");
+		fromSnapshot = !options.snapshot.empty() && manager.loadSnapshot(options.snapshot);
+		if (!fromSnapshot)
+		{
+			manager.loadCities();
+			manager.loadReservoirs();
+			manager.loadStations();
+			manager.loadPipes();
+		}
+	}
 	auto end = std::chrono::high_resolution_clock::now();
-	loadtime = std::chrono::duration<double>(end - start).count();
+	stageTime[LOAD] = std::chrono::duration<double>(end - start).count();
+	std::promise<void> loaded;
+	loaded.set_value();
+	stageDone[LOAD] = loaded.get_future().share();
+
+	startPipeline(options, !fromSnapshot);
 	mainMenu();
 }
 
+/**
+ * Runs the stages after the load one after the other in a background thread:
+ * the max flow (already known when loaded from a snapshot), the cities in deficit and
+ * the reliability analysis. The reliability results are reused from "./reliabilityCache.txt"
+ * ("./reliabilityCache_small.txt" for the small dataset) for the parts of the network that did
+ * not change since it was saved. In lazy mode they are only calculated when needed,
+ * another background thread filling them meanwhile.
+ * Until a stage is done, only the menus that do not need it may use the manager.
+*/
+void UI::startPipeline(const Options &options, bool calculateMaxFlow)
+{
+	auto promises = std::make_shared<std::array<std::promise<void>, STAGES>>();
+	for (int stage = MAX_FLOW; stage < STAGES; stage++)
+		stageDone[stage] = (*promises)[stage].get_future().share();
+
+	pipeline = std::async(std::launch::async, [this, options, calculateMaxFlow, promises]()
+	{
+		Trace::nameThread("pipeline");
+		auto run = [&](Stage stage, const std::function<void()> &task)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			{
+				TraceSpan span(STAGE_NAMES[stage], "startup");
+				task();
+			}
+			auto end = std::chrono::high_resolution_clock::now();
+			stageTime[stage] = std::chrono::duration<double>(end - start).count();
+			(*promises)[stage].set_value();
+		};
+
+		run(MAX_FLOW, [&]() {
+			if (calculateMaxFlow)
+				manager.maxFlowCities();
+		});
+		run(DEFICIT, [&]() { manager.citiesInDeficit(); });
+		run(RELIABILITY, [&]() {
+			if (options.lazy)
+				manager.startLazyReliability(options.memoCapacity);
+			else
+			{
+				std::string cachePath;
+				if (options.useCache)
+					cachePath = options.useSmallSet ? "./reliabilityCache_small.txt" : "./reliabilityCache.txt";
+				manager.reliabilityAnalysis(cachePath);
+			}
+		});
+	});
+}
+
+/**
+ * If a stage of the startup is done.
+*/
+bool UI::isDone(Stage stage) const
+{
+	return stageDone[stage].wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+/**
+ * Waits for a stage of the startup, and the ones before it, showing which are still running.
+*/
+void UI::waitFor(Stage stage)
+{
+	if (isDone(stage))
+		return;
+	CLEAR;
+	std::cout << "Please wait, the network is still being analysed:\n\n";
+	for (int s = LOAD; s <= stage; s++)
+	{
+		std::cout << " " << STAGE_NAMES[s] << " - ";
+		if (isDone((Stage)s))
+			std::cout << "done in " << stageTime[s] << "s\n";
+		else
+			std::cout << "running\n";
+	}
+	std::cout.flush();
+	stageDone[stage].wait();
+}
+
+/**
+ * Exits the program once nothing runs in the background: the reliability analysis still
+ * running is cancelled, the stages of the startup are waited for and the prefetcher of the
+ * lazy mode is stopped, so no thread is left using the manager, the statistics or the trace
+ * while the program exits.
+*/
+void UI::quit()
+{
+	manager.cancelAnalyses();
+	if (pipeline.valid())
+		pipeline.wait();
+	manager.stopPrefetch();
+	exit(0);
+}
+
 /**
  * Displays the main menu and awaits for a input from the user.
+ * Each menu first waits for the stage of the startup whose results it shows.
+ * The menus that change the flow of the network wait for all of them.
 */
 void UI::mainMenu()
 {
@@ -54,7 +257,17 @@ void UI::mainMenu()
 #else
         << "Welcome!\n"
 #endif
-		<< "The system was loaded in " << loadtime << "s.\n"
+		<< "The system was loaded in " << stageTime[LOAD] << "s.\n";
+		for (int stage = MAX_FLOW; stage < STAGES; stage++)
+		{
+			std::cout << " " << STAGE_NAMES[stage] << ": ";
+			if (isDone((Stage)stage))
+				std::cout << stageTime[stage] << "s\n";
+			else
+				std::cout << "running in the background\n";
+		}
+		std::cout
+		<< "\n"
 		<< "Select an option:\n"
         << "\n"
 		<< ">> Basic Service Metrics\n"
@@ -67,6 +280,12 @@ void UI::mainMenu()
 		<< " [5] Pump Station removal\n"
 		<< " [6] Pipeline removal\n"
 		<< "\n"
+		<< ">> Updates\n"
+		<< " [7] Change capacities and demands\n"
+		<< "\n"
+		<< ">> Diagnostics\n"
+		<< " [8] Solver statistics\n"
+		<< "\n"
 		<< "[Q] Exit\n"
 		<< "\n"
         << "$> ";
@@ -80,26 +299,39 @@ void UI::mainMenu()
 				case 'q':
 				case 'Q':
 					CLEAR;
-					exit(0);
+					quit();
 					break;
 				case '1':
+					waitFor(MAX_FLOW);
 					maxFlowMenu();
 					break;
 				case '2':
+					waitFor(DEFICIT);
 					meetDemandsMenu();
 					break;
 				case '3':
+					waitFor(RELIABILITY);
 					balancedFlowMenu();
 					break;
 				case '4':
+					waitFor(RELIABILITY);
 					removeReservoirMenu();
 					break;
 				case '5':
+					waitFor(RELIABILITY);
 					removePSMenu();
 					break;
 				case '6':
+					waitFor(RELIABILITY);
 					removePipeMenu();
 					break;
+				case '7':
+					waitFor(RELIABILITY);
+					updateNetworkMenu();
+					break;
+				case '8':
+					statsMenu();
+					break;
 				case 't':
 				case 'T':
 					testMenu();
@@ -148,3 +380,35 @@ void UI::testMenu()
 	std::cout << "\nGot " << count << " entries\nPress ENTER to continue...";
 	while (std::cin.get() != '\n') { }
 }
+
+/**
+ * Displays the counters and timers of the solvers, which can be switched on, off or reset.
+ * The stages running in the background keep adding to them while the menu is shown.
+*/
+void UI::statsMenu()
+{
+	while (1)
+	{
+		CLEAR;
+		Stats::print(std::cout);
+		std::cout
+		<< "\n"
+		<< "[S] - Switch " << (Stats::isEnabled() ? "off" : "on") << "\t[R] - Reset\n"
+		<< "[B] - Back \t\t[Q] - Exit\n"
+		<< "\n"
+		<< "$> ";
+		std::string str;
+		std::getline(std::cin, str);
+		if (str == "s" || str == "S")
+			Stats::setEnabled(!Stats::isEnabled());
+		else if (str == "r" || str == "R")
+			Stats::reset();
+		else if (str == "b" || str == "B")
+			return;
+		else if (str == "q" || str == "Q")
+		{
+			CLEAR;
+			quit();
+		}
+	}
+}
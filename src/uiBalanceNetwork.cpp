@@ -51,7 +51,7 @@ void UI::balancedFlowMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 		if (str == "B" || str == "b")
 			break;
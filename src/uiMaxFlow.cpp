@@ -23,20 +23,19 @@ bool UI::strFind(const std::string &one, const std::string &two) {
  * @param manager Manager containing the city list
  * @param searchTerm The term being searched
  * @note Complexity: O(n)
- * @return Map of matches
+ * @return List of matches
 */
-std::unordered_map<std::string, int> getSearchVertexes(Manager &manager, std::string searchTerm)
+FlowComb getSearchVertexes(Manager &manager, std::string searchTerm)
 {
-	std::unordered_map<std::string, int> result;
+	FlowComb result;
 
 	if (searchTerm.empty())
 		return result;
-	for (auto city : manager.cities)
+	for (auto city : manager.listCities(manager.maxFlows, false))
 	{
-		if (UI::strFind(city.second->getName(), searchTerm))
-			result[city.first] = manager.maxFlows[city.first];
-		else if (UI::strFind(city.second->getCode(), searchTerm))
-			result[city.first] = manager.maxFlows[city.first];
+		City *x = static_cast<City *>(manager.elementsById[city.first]);
+		if (UI::strFind(x->getName(), searchTerm) || UI::strFind(x->getCode(), searchTerm))
+			result.push_back(city);
 	}
 	return result;
 }
@@ -45,9 +44,9 @@ std::unordered_map<std::string, int> getSearchVertexes(Manager &manager, std::st
  * Gets the flow for a specific vertex of the graph
  * @note Complexity: O(IE) where IE is the number of incoming edges
 */
-int getFlow(Vertex *elem)
+Capacity getFlow(Vertex *elem)
 {
-	int total = 0;
+	Capacity total = 0;
 	for (auto i : elem->getIncoming())
 		total += i->getFlow();
 	return total;
@@ -58,7 +57,7 @@ int getFlow(Vertex *elem)
  * (static path: "./maxFlowOutput.txt").
  * @note Complexity: O(n)
 */
-void saveMaxFlow(Graph &graph, std::unordered_map<std::string, int> &lst, int maxFlow)
+void saveMaxFlow(Manager &manager, FlowComb &lst, Capacity maxFlow)
 {
 	std::ofstream out("./maxFlowOutput.txt", std::ofstream::trunc);
 
@@ -73,7 +72,7 @@ void saveMaxFlow(Graph &graph, std::unordered_map<std::string, int> &lst, int ma
 
 	for (auto w : lst)
 	{
-		City *city = dynamic_cast<City *>(graph.findVertexByCode(w.first)->getInfo());
+		City *city = dynamic_cast<City *>(manager.elementsById[w.first]);
 
 		if (city == nullptr)
 			continue;
@@ -88,7 +87,7 @@ void saveMaxFlow(Graph &graph, std::unordered_map<std::string, int> &lst, int ma
 */
 void UI::maxFlowMenu()
 {
-	std::unordered_map<std::string, int> lst = manager.maxFlows;
+	FlowComb lst = manager.listCities(manager.maxFlows, false);
 
 	size_t count = 0;
 	std::string str;
@@ -107,9 +106,8 @@ void UI::maxFlowMenu()
 		{
 			for (size_t i = count; i < std::min(count + 10, lst.size()); i++)
 			{
-				auto it = lst.begin();
-				std::advance(it, i);
-				Element *x = manager.network.findVertexByCode(it->first)->getInfo();
+				auto it = lst.begin() + i;
+				Element *x = manager.elementsById[it->first];
 				City *city = dynamic_cast<City *>(x);
 				std::cout << x->getCode();
 				if (city != nullptr) 
@@ -144,7 +142,7 @@ void UI::maxFlowMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 		if (str == "B" || str == "b")
 			break;
@@ -163,7 +161,7 @@ void UI::maxFlowMenu()
 
 		if (str == "save")
 		{
-			saveMaxFlow(manager.network, lst, manager.totalNetworkFlow);
+			saveMaxFlow(manager, lst, manager.totalNetworkFlow);
 			CLEAR;
 			std::cout << "Saved current search to \"./maxFlowOutput.txt\".\nPress ENTER to continue...";
 			while (std::cin.get() != '\n') { }
@@ -188,7 +186,7 @@ void UI::maxFlowMenu()
 		if (str == "reset")
 		{
 			search = "";
-			lst = manager.maxFlows;
+			lst = manager.listCities(manager.maxFlows, false);
 			totalPages = (lst.size() + 9 - (lst.size() - 1) % 10) / 10;
 			continue;
 		}
@@ -10,7 +10,7 @@
 */
 void UI::meetDemandsMenu()
 {
-	std::unordered_map<std::string, int> lst = manager.deficitcities;
+	FlowComb lst = manager.listCities(manager.deficitcities, true);
 
 	size_t count = 0;
 	std::string str;
@@ -28,9 +28,8 @@ void UI::meetDemandsMenu()
 		{
 			for (size_t i = count; i < std::min(count + 10, lst.size()); i++)
 			{
-				auto it = lst.begin();
-				std::advance(it, i);
-				Element *x = manager.network.findVertexByCode(it->first)->getInfo();
+				auto it = lst.begin() + i;
+				Element *x = manager.elementsById[it->first];
 
 				std::cout << x->getCode();
 				City *city = dynamic_cast<City *>(x);
@@ -63,7 +62,7 @@ void UI::meetDemandsMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 
 		if (str == "B" || str == "b")
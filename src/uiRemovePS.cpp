@@ -64,11 +64,11 @@ void UI::removePSMenu()
 		} 
 		else if (selected)
 		{
-			std::unordered_map<std::string, int> answ = manager.rmPS[selected->getCode()];
+			FlowComb answ = manager.stationFailure(selected);
 			std::cout << "Affected sites when removing \"" << selected->getCode() << "\":\n\n";
 			for (auto vtx : answ)
 			{
-				std::cout << vtx.first
+				std::cout << manager.elementsById[vtx.first]->getCode()
 				<< "\n Old flow: " << manager.maxFlows[vtx.first]
 				<< "\n New flow: " << vtx.second 
 				<< "\n\n";
@@ -101,7 +101,7 @@ void UI::removePSMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 
 		if (str == "B" || str == "b")
@@ -5,34 +5,37 @@
 #include <iomanip>
 
 /**
- * Searches the result cached unordered map created by maintenancePipes for pipelines matching with the search term.
- * @param manager Manager containing the unordered map
+ * Searches the pipelines listed by the menu for partial matches of their name with the search term.
+ * @param manager Manager containing the network
  * @param searchTerm The term being searched
  * @note Complexity: O(n)
- * @return Map of matches
+ * @return List of matches
 */
-RmResult getSearchPipe(Manager &manager, std::string searchTerm)
+std::vector<Edge *> getSearchPipe(Manager &manager, std::string searchTerm)
 {
-	RmResult result;
+	std::vector<Edge *> result;
 
 	if (searchTerm.empty())
 		return result;
-	for (auto x : manager.rmPipelines)
+	for (auto pipe : manager.listReportedPipes())
 	{
-		if (UI::strFind(x.first, searchTerm))
-			result[x.first] = x.second;
+		if (UI::strFind(manager.getPipeCode(pipe), searchTerm))
+			result.push_back(pipe);
 	}
 	return result;
 }
 
 /**
  * Shows all the cities affected if a pipeline from A to B is removed from the network.
- * A specific connect A to B can be searched
- * @note Complexity: O(n)
+ * A specific connect A to B can be searched.
+ * Only the pipelines that leave some city short are listed, except in lazy mode, where every
+ * pipeline is, and only those of the page shown are asked to the manager, so only their
+ * failures have to be analysed.
+ * @note Complexity: O(n), plus the analysis of the failures not known yet
 */
 void UI::removePipeMenu()
 {
-	RmResult lst = manager.rmPipelines;
+	std::vector<Edge *> lst = manager.listReportedPipes();
 
 	size_t count = 0;
 	std::string str;
@@ -52,11 +55,12 @@ void UI::removePipeMenu()
 		{
 			for (size_t i = count; i < std::min(count + 10, lst.size()); i++)
 			{
-				auto it = lst.begin();
-				std::advance(it, i);
-				std::cout << it->first << "\n\n";
-				for(auto n : it->second)
-            		std::cout << "  " << n.first << " - " << manager.maxFlows[n.first] << " --> " << n.second << "\n";
+				FlowComb affected = manager.pipeFailure(lst[i]);
+				std::cout << manager.getPipeCode(lst[i]) << "\n\n";
+				for(auto n : affected)
+            		std::cout << "  " << manager.elementsById[n.first]->getCode() << " - " << manager.maxFlows[n.first] << " --> " << n.second << "\n";
+				if (affected.empty())
+					std::cout << "  No city is affected\n";
 				std::cout << "\n";
 			}
 			std::cout << "Page " << (count + 10 - count % 10) / 10 << " of " 
@@ -85,7 +89,7 @@ void UI::removePipeMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 
 		if (str == "B" || str == "b")
@@ -121,7 +125,7 @@ void UI::removePipeMenu()
 		if (str == "reset")
 		{
 			search = "";
-			lst = manager.rmPipelines;
+			lst = manager.listReportedPipes();
 			totalPages = (lst.size() + 9 - (lst.size() - 1) % 10) / 10;
 			continue;
 		}
@@ -70,7 +70,7 @@ void UI::removeReservoirMenu()
 		} 
 		else if (selected)
 		{
-			std::vector<std::tuple<Vertex *, double, double>> answ = manager.removeReservoir(selected);
+			std::vector<std::tuple<Vertex *, Capacity, Capacity>> answ = manager.removeReservoir(selected);
 			std::cout << "Affected sites when removing \"" << selected->getCode() << " " << selected->getName() << "\":\n\n";
 			for (auto vtx : answ)
 			{
@@ -107,7 +107,7 @@ void UI::removeReservoirMenu()
         if (str == "Q" || str == "q")
 		{
 			CLEAR;
-            exit(0);
+            quit();
 		}
 
 		if (str == "B" || str == "b")
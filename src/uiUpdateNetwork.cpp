@@ -0,0 +1,127 @@
+#include "../headers/Ui.h"
+#include <sstream>
+
+/**
+ * Finds the pipe going from one element to another.
+ * @note Complexity: O(deg(origin))
+ * @return The pipe, nullptr if there is none
+*/
+Edge *findPipe(Manager &manager, const std::string &origin, const std::string &destination)
+{
+	Vertex *orig = manager.network.findVertexByCode(origin);
+	if (orig == nullptr)
+		return nullptr;
+	for (Edge *e : orig->getAdj())
+	{
+		if (e->getDest()->getInfo()->getCode() == destination)
+			return e;
+	}
+	return nullptr;
+}
+
+/**
+ * Displays the menu used to change the capacity of a pipe, the maximum delivery of a reservoir
+ * or the demand of a city. The max flow is repaired right away and the cities whose flow changed
+ * are shown. The reliability results are brought up to date afterwards.
+ * @note Complexity: O(n) plus the repair of the max flow
+*/
+void UI::updateNetworkMenu()
+{
+	std::string str;
+	std::string last;
+
+	while (1)
+	{
+		CLEAR;
+		std::cout
+		<< "Update the network:\n"
+		<< "\n"
+		<< "Total network flow: " << manager.totalNetworkFlow << "\n"
+		<< last
+		<< "\n"
+		<< "[pipe (origin) (destination) (capacity)] - Change the capacity of a pipe\n"
+		<< "[reservoir (code) (max delivery)] - Change the maximum delivery of a reservoir\n"
+		<< "[city (code) (demand)] - Change the demand of a city\n"
+		<< "[B] - Back \t\t[Q] - Exit\n"
+		<< "\n"
+		<< "$> ";
+
+		getline(std::cin, str);
+
+		if (str == "Q" || str == "q")
+		{
+			CLEAR;
+			quit();
+		}
+		if (str == "B" || str == "b")
+			break;
+
+		std::istringstream input(str);
+		std::string command, code, destination;
+		Capacity value = -1;
+		input >> command >> code;
+		// The value must be a number that is not negative, with nothing after it
+		auto readValue = [&input, &value]() {
+			input >> value;
+			return !input.fail() && value >= 0 && (input >> std::ws).eof();
+		};
+
+		std::vector<Capacity> oldFlows = manager.maxFlows;
+		Capacity oldTotal = manager.totalNetworkFlow;
+
+		if (command == "pipe")
+		{
+			input >> destination;
+			bool valid = readValue();
+			Edge *pipe = findPipe(manager, code, destination);
+			if (pipe == nullptr || !valid)
+			{
+				helpMsg("Pipe not found or invalid capacity", "pipe (origin) (destination) (capacity)");
+				continue;
+			}
+			manager.updatePipeCapacity(pipe, value);
+		}
+		else if (command == "reservoir")
+		{
+			bool valid = readValue();
+			auto it = manager.reservoirs.find(code);
+			if (it == manager.reservoirs.end() || !valid)
+			{
+				helpMsg("Reservoir not found or invalid delivery", "reservoir (code) (max delivery)");
+				continue;
+			}
+			manager.updateMaxDelivery(it->second, value);
+		}
+		else if (command == "city")
+		{
+			bool valid = readValue();
+			auto it = manager.cities.find(code);
+			if (it == manager.cities.end() || !valid)
+			{
+				helpMsg("City not found or invalid demand", "city (code) (demand)");
+				continue;
+			}
+			manager.updateDemand(it->second, value);
+		}
+		else
+		{
+			helpMsg("Command not found!", "pipe / reservoir / city / B / Q");
+			continue;
+		}
+
+		manager.refreshReliability();
+
+		std::ostringstream out;
+		out << "Previous total network flow: " << oldTotal << "\n\nCities whose flow changed:\n";
+		int changed = 0;
+		for (const auto &[city, flow] : manager.listCities(manager.maxFlows, false))
+		{
+			if (oldFlows[city] == flow)
+				continue;
+			out << manager.elementsById[city]->getCode() << " - " << oldFlows[city] << " -> " << flow << "\n";
+			changed++;
+		}
+		out << "Total count: " << changed << "\n";
+		last = out.str();
+	}
+}